@@ -1,10 +1,30 @@
 #include "AStar.hpp"
+#include "DeadEndFilter.hpp"
+#include "Components.hpp"
+#include "GoalBounds.hpp"
+#include "Swamps.hpp"
 #include <stack>
 #include <set>
 #include <chrono>
 #include <thread>
 
-AStar::AStar(Maze* maze) : maze(maze)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static inline uint32_t LowestBit(uint32_t x)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, x);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctz(x);
+#endif
+}
+
+AStar::AStar(Maze* maze, DeadEndFilter* filter, Components* components, GoalBounds* bounds, Swamps* swamps) :
+	maze(maze), filter(filter), components(components), bounds(bounds), swamps(swamps)
 {
 
 }
@@ -21,19 +41,19 @@ bool AStar::isDestination(int row, int col, const Pair& dest)
 // Function to calculate the 'h' heuristic. 
 double AStar::calculateHValue(distance_t type, int row, int col, const Pair& dest)
 {
-	// Return using the distance formula  based on the type:
+	// Return using the distance formula  based on the type, every move costing at least the cheapest cell:
 	if (type == EUCLIDEAN) { // Euclidean
 		return ((double)sqrt((row - dest.first)*(row - dest.first)
-			+ (col - dest.second)*(col - dest.second)));
+			+ (col - dest.second)*(col - dest.second))) * Maze::getMinCost();
 	} else if (type == MANHATTAN) { // Manhattan
-		return (double)(std::abs(row - dest.first) + std::abs(col - dest.second));
+		return (double)(std::abs(row - dest.first) + std::abs(col - dest.second)) * Maze::getMinCost();
 	}
 
 	return 0;
 }
 
 // Function to trace the path from the source to destination 
-std::stack<Pair> AStar::tracePath(const std::vector<std::vector<cell>>& cells, const Pair& dest)
+std::stack<Pair> AStar::tracePath(const std::vector<cell>& cells, const Pair& dest)
 {
 	SDL_Rect r;
 	r.w = maze->TILE_W;
@@ -44,10 +64,10 @@ std::stack<Pair> AStar::tracePath(const std::vector<std::vector<cell>>& cells, c
 	int col = dest.second;
 	std::stack<Pair> Path;
 
-	while (!(cells[row][col].parent_i == row && cells[row][col].parent_j == col)) {
+	while (!(cells[maze->GetIndex(row, col)].parent_i == row && cells[maze->GetIndex(row, col)].parent_j == col)) {
 		Path.push(std::make_pair(row, col));
-		int temp_row = cells[row][col].parent_i;
-		int temp_col = cells[row][col].parent_j;
+		int temp_row = cells[maze->GetIndex(row, col)].parent_i;
+		int temp_col = cells[maze->GetIndex(row, col)].parent_j;
 		row = temp_row;
 		col = temp_col;
 	}
@@ -77,16 +97,10 @@ std::stack<Pair> AStar::tracePath(const std::vector<std::vector<cell>>& cells, c
 // A Function to find the shortest path between src and dest using the A* Search Algorithm (type is the distance type)
 std::stack<Pair> AStar::AStarSearch(distance_t type, const Pair& src, const Pair& dest)
 {
-	int ROW = maze->H;
-	int COL = maze->W;
 	std::stack<Pair> res;
 
-	// All directions to check:
-	constexpr Pair coords[] = {
-		Pair(-1, -1), Pair(-1, 0), Pair(-1, 1),
-		Pair(0, -1)              , Pair(0, 1),
-		Pair(1, -1), Pair(1, 0)  , Pair(1, 1),
-	};
+	// All directions to check, bit d of Maze::getMoves is the move coords[d]:
+	const Pair* coords = Maze::MOVES;
 
 	// If the source is out of range 
 	if (maze->isValid(src.first, src.second) == false) {
@@ -112,31 +126,51 @@ std::stack<Pair> AStar::AStarSearch(distance_t type, const Pair& src, const Pair
 		return res;
 	}
 
-	// Create a closed list and initialise it to false which means  
-	std::vector<std::vector<bool>> closedList(ROW, std::vector<bool>(COL, false));
+	// Nothing to search if they are in different parts of the maze
+	if (components && !components->Connected(src, dest)) {
+		printf("The destination can't be reached\n");
+		return res;
+	}
+
+	// Dead ends (but the source and the destination) can't be on the path
+	if (filter) {
+		filter->Update(src, dest);
+	}
+
+	// And so are the regions only entered through one cell, unless the source or the destination is inside
+	if (swamps) {
+		swamps->Update(src, dest);
+	}
+
+	// Open neighbours of every cell, the sentinels around the maze are walls: no bounds to check while expanding
+	maze->UpdateMoves();
 
-	// Declare a 2D array of structure to hold the details of that cell 
-	std::vector<std::vector<cell>> cells(ROW, std::vector<cell>(COL));
+	// Moves whose cheapest paths never go near the destination are skipped
+	GoalBounds* bounds = (this->bounds && this->bounds->Update()) ? this->bounds : NULL;
+
+	// Create a closed list and initialise it to false which means  
+	// (the state of the cells follows the layout of the grid: tiled, the neighbours are mostly in the same cache line)
+	std::vector<bool> closedList(maze->GetIndexCount(), false);
+
+	// Declare an array of structure to hold the details of that cell 
+	cell init;
+	init.f = FLT_MAX;
+	init.g = FLT_MAX;
+	init.h = FLT_MAX;
+	init.parent_i = -1;
+	init.parent_j = -1;
+	std::vector<cell> cells(maze->GetIndexCount(), init);
 
 	int i, j;
-	// Init verything:
-	for (i = 0; i < ROW; i++) {
-		for (j = 0; j < COL; j++) {
-			cells[i][j].f = FLT_MAX;
-			cells[i][j].g = FLT_MAX;
-			cells[i][j].h = FLT_MAX;
-			cells[i][j].parent_i = -1;
-			cells[i][j].parent_j = -1;
-		}
-	}
 
 	// Initialising the parameters of the starting node 
 	i = src.first, j = src.second;
-	cells[i][j].f = 0.0;
-	cells[i][j].g = 0.0;
-	cells[i][j].h = 0.0;
-	cells[i][j].parent_i = i;
-	cells[i][j].parent_j = j;
+	cell& first = cells[maze->GetIndex(i, j)];
+	first.f = 0.0;
+	first.g = 0.0;
+	first.h = 0.0;
+	first.parent_i = i;
+	first.parent_j = j;
 
 	// Create an open list having information as-<f, <i, j>>
 	// where f = g + h, and i, j are the row and column index of that cell
@@ -163,7 +197,7 @@ std::stack<Pair> AStar::AStarSearch(distance_t type, const Pair& src, const Pair
 		// Add this vertex to the closed list 
 		i = p.second.first;
 		j = p.second.second;
-		closedList[i][j] = true;
+		closedList[maze->GetIndex(i, j)] = true;
 
 		// Render the cell we are visiting
 		SDL_SetRenderTarget(maze->renderer, maze->texture);
@@ -178,36 +212,38 @@ std::stack<Pair> AStar::AStarSearch(distance_t type, const Pair& src, const Pair
 		// To store the 'g', 'h' and 'f' of the 8 successors 
 		double newG, newH, newF;
 
-		// Process the neighbour cells
-		for (const Pair& dir : coords) {
-			uint32_t dirX = dir.first;
-			uint32_t dirY = dir.second;
-
-			if (maze->isValid(i + dirX, j + dirY) == true) {
-				// If the destination cell is the same as the current successor 
-				if (isDestination(i + dirX, j + dirY, dest) == true) {
-					// Set the Parent of the destination cell 
-					cells[i + dirX][j + dirY].parent_i = i;
-					cells[i + dirX][j + dirY].parent_j = j;
-					// printf("The destination cell is found\n");
-					foundDest = true;
-					res = tracePath(cells, dest);
-					return res; // return the path
-				} else if (closedList[i + dirX][j + dirY] == false && maze->isUnBlocked(i + dirX, j + dirY) == true) {
-					newG = cells[i][j].g + maze->getCellCost(i + dirX, j + dirY);
-					newH = calculateHValue(type, i + dirX, j + dirY, dest);
-					newF = newG + newH;
-
-					if (cells[i + dirX][j + dirY].f == FLT_MAX || cells[i + dirX][j + dirY].f > newF) {
-						openList.insert(std::make_pair(newF, std::make_pair(i + dirX, j + dirY)));
-
-						// Update the details of this cell 
-						cells[i + dirX][j + dirY].f = newF;
-						cells[i + dirX][j + dirY].g = newG;
-						cells[i + dirX][j + dirY].h = newH;
-						cells[i + dirX][j + dirY].parent_i = i;
-						cells[i + dirX][j + dirY].parent_j = j;
-					}
+		// Process the open neighbour cells
+		for (uint32_t open = maze->getMoves(i, j); open; open &= open - 1) {
+			uint32_t d = LowestBit(open);
+			int dirX = coords[d].first;
+			int dirY = coords[d].second;
+
+			cell& next = cells[maze->GetIndex(i + dirX, j + dirY)];
+
+			// If the destination cell is the same as the current successor 
+			if (isDestination(i + dirX, j + dirY, dest) == true) {
+				// Set the Parent of the destination cell 
+				next.parent_i = i;
+				next.parent_j = j;
+				// printf("The destination cell is found\n");
+				foundDest = true;
+				res = tracePath(cells, dest);
+				return res; // return the path
+			} else if (closedList[maze->GetIndex(i + dirX, j + dirY)] == false && !(filter && filter->IsPruned(i + dirX, j + dirY)) && !(swamps && swamps->IsSwamp(i + dirX, j + dirY))
+				&& !(bounds && !bounds->Contains(i, j, d, dest))) {
+				newG = cells[maze->GetIndex(i, j)].g + maze->getCellCost(i + dirX, j + dirY);
+				newH = calculateHValue(type, i + dirX, j + dirY, dest);
+				newF = newG + newH;
+
+				if (next.f == FLT_MAX || next.f > newF) {
+					openList.insert(std::make_pair(newF, std::make_pair(i + dirX, j + dirY)));
+
+					// Update the details of this cell 
+					next.f = newF;
+					next.g = newG;
+					next.h = newH;
+					next.parent_i = i;
+					next.parent_j = j;
 				}
 			}
 		}
@@ -5,6 +5,10 @@
 #include <float.h>
 
 class Maze;
+class DeadEndFilter;
+class Components;
+class GoalBounds;
+class Swamps;
 
 class AStar
 {
@@ -22,15 +26,20 @@ public:
 		MANHATTAN = 1,
 	};
 public:
-	AStar(Maze* maze);
+	AStar(Maze* maze, DeadEndFilter* filter = NULL, Components* components = NULL, GoalBounds* bounds = NULL, Swamps* swamps = NULL);
 
 	bool isDestination(int row, int col, const Pair& dest);
 
 	std::stack<Pair> AStarSearch(distance_t type, const Pair& src, const Pair& dest);
 
-	std::stack<Pair> tracePath(const std::vector<std::vector<cell>>& cellDetails, const Pair& dest);
+	// The cells are in the order of Maze::GetIndex
+	std::stack<Pair> tracePath(const std::vector<cell>& cellDetails, const Pair& dest);
 
 	double calculateHValue(distance_t type, int row, int col, const Pair& dest);
 private:
 	Maze* maze;
+	DeadEndFilter* filter; // Cells that can be skipped
+	Components* components; // Rejects the destinations that can't be reached
+	GoalBounds* bounds; // Moves that can't lead to the destination
+	Swamps* swamps; // Regions behind a single gate that can be skipped
 };
\ No newline at end of file
@@ -0,0 +1,386 @@
+#include "Benchmark.hpp"
+#include "Simulation.hpp"
+#include "ContractionHierarchy.hpp"
+#include "JunctionGraph.hpp"
+#include "SubgoalGraph.hpp"
+#include "TransitNodes.hpp"
+#include "EllerGenerator.hpp"
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static inline uint32_t LowestBit(uint32_t x)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, x);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctz(x);
+#endif
+}
+
+typedef std::pair<uint32_t, uint32_t> entry_t; // <f, cell>
+
+// Arrays of GridSearch kept from one search to the next, the costs in the order of Maze::GetIndex
+struct GridState
+{
+	std::vector<uint32_t> g;
+	std::vector<uint32_t> reached; // Indices to reset
+	std::vector<entry_t> openList;
+};
+
+// A* over the cells with the moves of AStar (8 directions, cost of the cell entered) and the
+// Chebyshev distance, without the rendering. Returns the cost, UINT32_MAX without path.
+// The neighbours are the bits of Maze::getMoves, the masks are updated before the searches
+static uint32_t GridSearch(Maze* maze, const Pair& s, const Pair& t, uint32_t& expanded, GridState& state)
+{
+	int COL = maze->GetCols();
+	std::vector<uint32_t>& g = state.g;
+	std::vector<entry_t>& openList = state.openList;
+	uint32_t T = t.first * COL + t.second;
+	uint32_t cost = UINT32_MAX;
+
+	if (g.size() != maze->GetIndexCount())
+		g.assign(maze->GetIndexCount(), UINT32_MAX);
+
+	auto h = [&](uint32_t c) {
+		return (uint32_t)std::max(std::abs((int)(c / COL) - t.first), std::abs((int)(c % COL) - t.second)) * Maze::getMinCost();
+	};
+
+	expanded = 0;
+	openList.clear();
+	g[maze->GetIndex(s.first, s.second)] = 0;
+	state.reached.push_back((uint32_t)maze->GetIndex(s.first, s.second));
+	openList.push_back(entry_t(h(s.first * COL + s.second), s.first * COL + s.second));
+
+	while (!openList.empty()) {
+		std::pop_heap(openList.begin(), openList.end(), std::greater<entry_t>());
+		entry_t e = openList.back();
+		openList.pop_back();
+		int i = e.second / COL;
+		int j = e.second % COL;
+		uint32_t gu = g[maze->GetIndex(i, j)];
+
+		if (e.first != gu + h(e.second))
+			continue;
+
+		if (e.second == T) {
+			cost = gu;
+			break;
+		}
+
+		expanded++;
+
+		for (uint32_t open = maze->getMoves(i, j); open; open &= open - 1) {
+			const Pair& move = Maze::MOVES[LowestBit(open)];
+			int di = move.first;
+			int dj = move.second;
+			uint32_t v = (i + di) * COL + j + dj;
+			uint32_t& gv = g[maze->GetIndex(i + di, j + dj)];
+			uint32_t next = gu + maze->getCellCost(i + di, j + dj);
+
+			if (next < gv) {
+				if (gv == UINT32_MAX)
+					state.reached.push_back((uint32_t)maze->GetIndex(i + di, j + dj));
+
+				gv = next;
+				openList.push_back(entry_t(next + h(v), v));
+				std::push_heap(openList.begin(), openList.end(), std::greater<entry_t>());
+			}
+		}
+	}
+
+	for (uint32_t index : state.reached)
+		g[index] = UINT32_MAX;
+
+	state.reached.clear();
+	return cost;
+}
+
+// Cache lines of 64 bytes holding a cell and its 8 neighbours, on average over open cells: lines of
+// the grid, and of an array of 4-byte states in the order of Maze::GetIndex (as the costs of GridSearch)
+static void NeighbourLines(Maze* maze, const std::vector<Pair>& cells, double& grid, double& state)
+{
+	uint32_t samples = (uint32_t)std::min<size_t>(cells.size(), 1 << 20);
+	uint64_t bits = maze->GetMazeArray().GetBits();
+	uint64_t grid_lines = 0, state_lines = 0;
+
+	for (uint32_t k = 0; k < samples; k++) {
+		const Pair& cell = cells[(size_t)k * cells.size() / samples];
+		size_t lines[2][9];
+		uint32_t n = 0;
+
+		for (int di = -1; di <= 1; di++) {
+			for (int dj = -1; dj <= 1; dj++) {
+				if (!maze->isValid(cell.first + di, cell.second + dj))
+					continue;
+
+				size_t index = maze->GetIndex(cell.first + di, cell.second + dj);
+				lines[0][n] = index * bits / 512;
+				lines[1][n] = index * 4 / 64;
+				n++;
+			}
+		}
+
+		for (int a = 0; a < 2; a++) {
+			std::sort(lines[a], lines[a] + n);
+			(a == 0 ? grid_lines : state_lines) += std::unique(lines[a], lines[a] + n) - lines[a];
+		}
+	}
+
+	grid = samples > 0 ? (double)grid_lines / samples : 0;
+	state = samples > 0 ? (double)state_lines / samples : 0;
+}
+
+void Benchmark::Simulate(Maze* maze, uint32_t cats, uint32_t mice, uint32_t ticks, uint32_t threads)
+{
+	Simulation simulation(maze, threads);
+	simulation.Spawn(cats, mice, maze->getSeed());
+
+	auto begin = std::chrono::steady_clock::now();
+
+	for (uint32_t i = 0; i < ticks; i++) {
+		simulation.Tick();
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+	printf("Simulated %u ticks of %u cats and %u mice on %u threads in %.3f s: %.1f ticks/s, %llu mice caught\n",
+		ticks, cats, mice, simulation.GetThreadCount(), seconds, seconds > 0 ? ticks / seconds : 0.0,
+		(unsigned long long)simulation.getCaught());
+}
+
+void Benchmark::Queries(Maze* maze, uint32_t count, uint32_t threads, const char* file)
+{
+	ContractionHierarchy ch(maze);
+	auto begin = std::chrono::steady_clock::now();
+
+	if (!file || !ch.Load(file)) {
+		ch.Build(threads);
+
+		if (file)
+			ch.Save(file);
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	printf("Contraction hierarchy of %u nodes (core of %u) and %u shortcuts ready in %.3f s\n", ch.GetNodeCount(), ch.GetCoreCount(), ch.GetShortcutCount(), seconds);
+
+	std::vector<Pair> cells;
+
+	for (int i = 0; i < maze->GetRows(); i++) {
+		for (int j = 0; j < maze->GetCols(); j++) {
+			if (maze->isUnBlocked(i, j))
+				cells.push_back(Pair(i, j));
+		}
+	}
+
+	if (cells.empty())
+		return;
+
+	JunctionGraph junctions(maze);
+	junctions.Update();
+
+	TransitNodes transit(maze);
+	bool tables = transit.Update();
+
+	double ch_time = 0, junctions_time = 0, transit_time = 0;
+	uint64_t ch_settled = 0, junctions_settled = 0, transit_lookups = 0;
+	uint32_t errors = 0;
+
+	for (uint32_t i = 0; i < count; i++) {
+		const Pair& s = cells[rand() % cells.size()];
+		const Pair& t = cells[rand() % cells.size()];
+		uint32_t ch_cost, junctions_cost;
+
+		begin = std::chrono::steady_clock::now();
+		ch.Query(s, t, ch_cost);
+		ch_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		ch_settled += ch.getSettled();
+
+		begin = std::chrono::steady_clock::now();
+		junctions.Search(s, t, junctions_cost);
+		junctions_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		junctions_settled += junctions.GetVisited().size();
+
+		if (ch_cost != junctions_cost)
+			errors++;
+
+		if (tables) {
+			uint32_t transit_cost;
+			begin = std::chrono::steady_clock::now();
+			transit.Query(s, t, transit_cost);
+			transit_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+			transit_lookups += transit.getLookups();
+
+			if (transit_cost != junctions_cost)
+				errors++;
+		}
+	}
+
+	if (count == 0)
+		return;
+
+	printf("%u queries: contraction hierarchy %.1f us and %.1f nodes settled, junction graph %.1f us and %.1f nodes settled, %u different costs\n",
+		count, ch_time * 1e6 / count, (double)ch_settled / count, junctions_time * 1e6 / count, (double)junctions_settled / count, errors);
+
+	if (tables)
+		printf("Transit nodes %.1f us and %.1f table lookups\n", transit_time * 1e6 / count, (double)transit_lookups / count);
+}
+
+void Benchmark::Subgoals(Maze* maze, uint32_t count, uint32_t threads)
+{
+	SubgoalGraph subgoals(maze);
+	auto begin = std::chrono::steady_clock::now();
+	subgoals.Build(threads);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+	printf("Subgoal graph of %u subgoals (%u global) and %u edges (%u between global subgoals) built in %.3f s\n", subgoals.GetSubgoalCount(),
+		subgoals.GetGlobalCount(), subgoals.GetEdgeCount(), subgoals.GetGlobalEdgeCount(), seconds);
+
+	std::vector<Pair> cells;
+
+	for (int i = 0; i < maze->GetRows(); i++) {
+		for (int j = 0; j < maze->GetCols(); j++) {
+			if (maze->isUnBlocked(i, j))
+				cells.push_back(Pair(i, j));
+		}
+	}
+
+	if (cells.empty() || count == 0)
+		return;
+
+	GridState state;
+	maze->UpdateMoves();
+	double subgoals_time = 0, grid_time = 0;
+	uint64_t subgoals_expanded = 0, grid_expanded = 0;
+	uint32_t errors = 0;
+
+	for (uint32_t i = 0; i < count; i++) {
+		const Pair& s = cells[rand() % cells.size()];
+		const Pair& t = cells[rand() % cells.size()];
+		uint32_t subgoals_cost, grid_cost, expanded;
+
+		begin = std::chrono::steady_clock::now();
+		subgoals.Search(s, t, subgoals_cost);
+		subgoals_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		subgoals_expanded += subgoals.getExpanded();
+
+		begin = std::chrono::steady_clock::now();
+		grid_cost = GridSearch(maze, s, t, expanded, state);
+		grid_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		grid_expanded += expanded;
+
+		if (subgoals_cost != grid_cost)
+			errors++;
+	}
+
+	printf("%u searches: subgoal graph %.1f us and %.1f expansions, grid A* %.1f us and %.1f expansions (%.1fx faster), %u different costs\n",
+		count, subgoals_time * 1e6 / count, (double)subgoals_expanded / count, grid_time * 1e6 / count, (double)grid_expanded / count,
+		subgoals_time > 0 ? grid_time / subgoals_time : 0.0, errors);
+}
+
+void Benchmark::Stream(uint32_t width, uint64_t height, const char* file, uint64_t seed)
+{
+	bool console = strcmp(file, "-") == 0;
+	FILE* out = console ? stdout : fopen(file, "wb");
+
+	if (!out) {
+		printf("Can't open '%s'\n", file);
+		return;
+	}
+
+	EllerGenerator generator(width, seed);
+	auto begin = std::chrono::steady_clock::now();
+	uint64_t rows = generator.Generate(height, EllerGenerator::FileSink(out));
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	double bytes = (double)rows * generator.GetCols();
+
+	if (!console)
+		fclose(out);
+
+	// The maze itself may be on the standard output
+	fprintf(stderr, "%llu rows of %u bytes streamed in %.3f s (%.1f MB/s)\n", (unsigned long long)rows, generator.GetCols(), seconds,
+		seconds > 0 ? bytes / seconds / 1e6 : 0.);
+}
+
+void Benchmark::OpenMaze(Maze* maze, uint32_t blocks)
+{
+	int ROW = maze->GetRows();
+	int COL = maze->GetCols();
+
+	maze->Reset();
+
+	for (uint32_t k = 0; k < blocks; k++) {
+		int row = 1 + rand() % (ROW - 3);
+		int col = 1 + rand() % (COL - 3);
+		int size = 1 + rand() % 4;
+
+		for (int i = row; i < std::min(row + size, ROW - 2); i++) {
+			for (int j = col; j < std::min(col + size, COL - 2); j++)
+				maze->SetCell(Maze::WALL, i, j);
+		}
+	}
+}
+
+void Benchmark::Layouts(Maze* rows, Maze* tiles, uint32_t count)
+{
+	std::vector<Pair> cells;
+
+	for (int i = 0; i < rows->GetRows(); i++) {
+		for (int j = 0; j < rows->GetCols(); j++) {
+			if (rows->GetMazeArray().Get(i, j) != tiles->GetMazeArray().Get(i, j)) {
+				printf("The mazes in both layouts are different\n");
+				return;
+			}
+
+			if (rows->isUnBlocked(i, j))
+				cells.push_back(Pair(i, j));
+		}
+	}
+
+	if (cells.empty() || count == 0)
+		return;
+
+	Maze* mazes[2] = { rows, tiles };
+	const char* names[2] = { "rows", "tiles" };
+	GridState states[2];
+	double times[2] = { 0, 0 };
+	uint64_t expanded[2] = { 0, 0 };
+	uint32_t errors = 0;
+	rows->UpdateMoves();
+	tiles->UpdateMoves();
+
+	for (uint32_t i = 0; i < count; i++) {
+		const Pair& s = cells[rand() % cells.size()];
+		const Pair& t = cells[rand() % cells.size()];
+		uint32_t costs[2];
+
+		for (int k = 0; k < 2; k++) {
+			uint32_t e;
+			auto begin = std::chrono::steady_clock::now();
+			costs[k] = GridSearch(mazes[k], s, t, e, states[k]);
+			times[k] += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+			expanded[k] += e;
+		}
+
+		if (costs[0] != costs[1])
+			errors++;
+	}
+
+	for (int k = 0; k < 2; k++) {
+		double grid, state;
+		NeighbourLines(mazes[k], cells, grid, state);
+		printf("%-5s %u searches: %.2f ms and %.0f expansions each, %.1f ns per expansion, a cell and its neighbours on %.2f lines of the grid and %.2f of the state\n",
+			names[k], count, times[k] * 1e3 / count, (double)expanded[k] / count, expanded[k] > 0 ? times[k] * 1e9 / expanded[k] : 0., grid, state);
+	}
+
+	printf("Tiles %.2fx faster, %u different costs\n", times[1] > 0 ? times[0] / times[1] : 0., errors);
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "maze.hpp"
+
+class Maze;
+
+// Headless measurements, started from the command line
+class Benchmark
+{
+public:
+	// Run the multi-agent Cat & Mouse and report the number of ticks per second
+	static void Simulate(Maze* maze, uint32_t cats, uint32_t mice, uint32_t ticks, uint32_t threads);
+
+	// Preprocess a contraction hierarchy (or load it from the file) and the transit node tables, and time
+	// random Dijkstra queries against the junction graph, checking that they all find the same costs
+	static void Queries(Maze* maze, uint32_t count, uint32_t threads, const char* file);
+
+	// Build the subgoal graph and time random searches against a grid A* with the same moves
+	static void Subgoals(Maze* maze, uint32_t count, uint32_t threads);
+
+	// Stream a maze of 'width' cells and 'height' rows (0: no end) with Eller's algorithm to the file ("-" for the standard output)
+	static void Stream(uint32_t width, uint64_t height, const char* file, uint64_t seed);
+
+	// Time random grid A* searches on the same maze stored row after row and in tiles, with the
+	// cache lines a cell and its neighbours span in both (hardware counts come from perf stat)
+	static void Layouts(Maze* rows, Maze* tiles, uint32_t count);
+
+	// Reset the maze and paint square blocks of walls, for the benchmarks on open mazes
+	static void OpenMaze(Maze* maze, uint32_t blocks);
+};
\ No newline at end of file
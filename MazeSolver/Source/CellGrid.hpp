@@ -0,0 +1,185 @@
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+
+// Cell types of the maze packed in 64-bit words, row after row, each row starting on a new word.
+// A cell takes a byte, or 4 bits when all the types of the maze are below 16 (a billion cells
+// then fit in 500 MB). Threads may write cells of different words at the same time only.
+//
+// Tiled, the grid is cut in tiles of 8x8 cells stored one after the other, a tile in one cache
+// line (half of one when packed): the cells above and below are then most of the time in the
+// same line instead of a row away. Index() orders the state of a search the same way.
+//
+// A ring of sentinel cells goes around the grid: the neighbours of any cell can be read, rows -1
+// and GetRows(), columns -1 and GetCols() included, without checking the bounds first.
+class CellGrid
+{
+public:
+	static constexpr uint32_t TILE = 8;
+
+	CellGrid() : rows(0), cols(0), stride(0), rowPad(0), colPad(0), tiled(false), bitShift(3), laneShift(3), cellMask(0xff)
+	{
+	}
+
+	// bits is 8 or 4, the ring around the grid holds sentinel cells
+	CellGrid(int rows, int cols, uint8_t type, uint32_t bits = 8, bool tiled = false, uint8_t sentinel = 0) : rows(rows), cols(cols), tiled(tiled)
+	{
+		bitShift = bits == 4 ? 2 : 3;
+		laneShift = 6 - bitShift;
+		cellMask = (1u << (1 << bitShift)) - 1;
+
+		// The padding is a word of cells wide (a tile when tiled): the words of the grid are the same with or without it
+		rowPad = tiled ? TILE : 1;
+		colPad = tiled ? TILE : 1 << laneShift;
+		size_t height = (size_t)rows + 2 * rowPad;
+		size_t width = (size_t)cols + 2 * colPad;
+
+		// Cells per row of words, or tiles per row of tiles
+		if (tiled) {
+			stride = (width + TILE - 1) / TILE;
+			words.assign(((height + TILE - 1) / TILE * stride * TILE * TILE) >> laneShift, Broadcast(type));
+		} else {
+			stride = ((width + (1 << laneShift) - 1) >> laneShift) << laneShift;
+			words.assign((height * stride) >> laneShift, Broadcast(type));
+		}
+
+		for (int col = -1; col <= cols; col++) {
+			this->Set(-1, col, sentinel);
+			this->Set(rows, col, sentinel);
+		}
+
+		for (int row = 0; row < rows; row++) {
+			this->Set(row, -1, sentinel);
+			this->Set(row, cols, sentinel);
+		}
+	}
+
+	uint8_t Get(int row, int col) const
+	{
+		size_t index = this->Index(row, col);
+		return (uint8_t)((words[index >> laneShift] >> this->Shift(index)) & cellMask);
+	}
+
+	void Set(int row, int col, uint8_t type)
+	{
+		size_t index = this->Index(row, col);
+		uint64_t& word = words[index >> laneShift];
+		uint32_t shift = this->Shift(index);
+		word = (word & ~((uint64_t)cellMask << shift)) | ((uint64_t)(type & cellMask) << shift);
+	}
+
+	// Place of the cell in the grid (the ring around included), below GetCapacity()
+	size_t Index(int row, int col) const
+	{
+		size_t r = row + rowPad;
+		size_t c = col + colPad;
+
+		if (tiled)
+			return ((r / TILE) * stride + c / TILE) * TILE * TILE + (r % TILE) * TILE + c % TILE;
+
+		return r * stride + c;
+	}
+
+	size_t GetCapacity() const { return words.size() << laneShift; }
+
+	bool IsTiled() const { return tiled; }
+
+	// Bits (64 cells per word) of the cells of the row whose type is flagged in types (256 flags).
+	// Packed cells are compared 16 at a time (8 when tiled) to every flagged type, or to the others when fewer
+	void MatchRow(int row, const uint8_t* types, uint64_t* mask) const
+	{
+		uint32_t run = tiled ? TILE : 1 << laneShift; // Cells of the row side by side in a word
+		uint32_t count = 0, compared[16];
+		bool inverted = false;
+
+		if (bitShift == 2) {
+			for (uint32_t type = 0; type < 16; type++)
+				count += types[type] != 0;
+
+			inverted = count > 8;
+			count = 0;
+
+			for (uint32_t type = 0; type < 16; type++) {
+				if ((types[type] != 0) != inverted)
+					compared[count++] = type;
+			}
+		}
+
+		uint32_t maskWords = (cols + 63) / 64;
+
+		for (uint32_t m = 0; m < maskWords; m++)
+			mask[m] = 0;
+
+		for (int col = 0; col < cols; col += run) {
+			size_t index = this->Index(row, col);
+			uint64_t word = words[index >> laneShift] >> this->Shift(index);
+			uint64_t match = 0;
+
+			if (bitShift == 2) {
+				for (uint32_t t = 0; t < count; t++)
+					match |= ZeroNibbles(word ^ Broadcast((uint8_t)compared[t]));
+
+				match = GatherNibbles(inverted ? ~match & this->LowBits() : match);
+			} else {
+				for (uint32_t lane = 0; lane < run; lane++)
+					match |= (uint64_t)(types[(word >> (8 * lane)) & 0xff] != 0) << lane;
+			}
+
+			mask[col / 64] |= (match & (~0ull >> (64 - run))) << (col % 64);
+		}
+
+		// The padding at the end of the row isn't part of the maze
+		if (cols % 64 && maskWords > 0)
+			mask[maskWords - 1] &= (1ull << (cols % 64)) - 1;
+	}
+
+	bool operator==(const CellGrid& other) const
+	{
+		return rows == other.rows && cols == other.cols && tiled == other.tiled && cellMask == other.cellMask && words == other.words;
+	}
+
+	int GetRows() const { return rows; }
+
+	int GetCols() const { return cols; }
+
+	// Bits per cell, 8 or 4
+	uint32_t GetBits() const { return 1 << bitShift; }
+
+	// Highest type a cell can hold
+	uint32_t GetMaxType() const { return cellMask; }
+
+	size_t GetBytes() const { return words.size() * sizeof(uint64_t); }
+private:
+	uint32_t Shift(size_t index) const { return (index & ((1 << laneShift) - 1)) << bitShift; }
+
+	// The lowest bit of every lane
+	uint64_t LowBits() const { return bitShift == 2 ? 0x1111111111111111ull : 0x0101010101010101ull; }
+
+	uint64_t Broadcast(uint8_t type) const { return (uint64_t)(type & cellMask) * this->LowBits(); }
+
+	// The lowest bit of the nibbles holding 0
+	static uint64_t ZeroNibbles(uint64_t word)
+	{
+		word |= word >> 1;
+		word |= word >> 2;
+		return ~word & 0x1111111111111111ull;
+	}
+
+	// The lowest bits of the 16 nibbles next to each other
+	static uint64_t GatherNibbles(uint64_t x)
+	{
+		x = (x | (x >> 3)) & 0x0303030303030303ull;
+		x = (x | (x >> 6)) & 0x000f000f000f000full;
+		x = (x | (x >> 12)) & 0x000000ff000000ffull;
+		return (x | (x >> 24)) & 0xffff;
+	}
+
+	std::vector<uint64_t> words;
+	int rows, cols;
+	size_t stride; // Cells per row, or tiles per row of tiles
+	uint32_t rowPad, colPad; // Around the grid
+	bool tiled;
+	uint32_t bitShift, laneShift; // Log2 of the bits per cell and of the cells per word
+	uint32_t cellMask;
+};
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "Components.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+static constexpr uint32_t NONE = UINT32_MAX;
+
+Components::Components(Maze* maze, Maze::moves_t moves) : maze(maze), moves(moves), revision(0), built(false), count(0)
+{
+}
+
+uint32_t Components::Find(uint32_t cell)
+{
+	while (parent[cell] != cell) {
+		parent[cell] = parent[parent[cell]]; // Path halving
+		cell = parent[cell];
+	}
+
+	return cell;
+}
+
+// The smallest root wins, returns false if both cells were already together
+bool Components::Link(uint32_t a, uint32_t b)
+{
+	a = this->Find(a);
+	b = this->Find(b);
+
+	if (a == b)
+		return false;
+
+	parent[std::max(a, b)] = std::min(a, b);
+	return true;
+}
+
+uint32_t Components::Join(uint32_t cell, uint32_t r0, uint32_t r1)
+{
+	int COL = maze->GetCols();
+	int i = cell / COL;
+	int j = cell % COL;
+	uint32_t links = 0;
+
+	for (int di = -1; di <= 1; di++) {
+		for (int dj = -1; dj <= 1; dj++) {
+			if ((di == 0 && dj == 0) || (moves == Maze::MOVES_4 && di != 0 && dj != 0))
+				continue;
+
+			int ni = i + di;
+			int nj = j + dj;
+
+			if (ni < (int)r0 || ni >= (int)r1 || !maze->isValid(ni, nj) || parent[ni * COL + nj] == NONE)
+				continue;
+
+			if (this->Link(cell, ni * COL + nj))
+				links++;
+		}
+	}
+
+	return links;
+}
+
+void Components::Build()
+{
+	uint32_t ROW = maze->GetRows();
+	uint32_t COL = maze->GetCols();
+
+	parent.assign(ROW * COL, NONE);
+	count = 0;
+
+	for (uint32_t c = 0; c < ROW * COL; c++) {
+		if (maze->isUnBlocked(c / COL, c % COL)) {
+			parent[c] = c;
+			count++;
+		}
+	}
+
+	// Every band only links cells of its own rows
+	ThreadPool pool(maze->GetThreadCount());
+	uint32_t band = std::max(8u, ROW / pool.GetThreadCount());
+	uint32_t bands = (ROW + band - 1) / band;
+	std::vector<uint32_t> links(bands, 0);
+
+	pool.ParallelFor(bands, [&](uint32_t begin, uint32_t end, uint32_t) {
+		for (uint32_t b = begin; b < end; b++) {
+			uint32_t r0 = b * band;
+			uint32_t r1 = std::min(ROW, r0 + band);
+
+			for (uint32_t c = r0 * COL; c < r1 * COL; c++) {
+				if (parent[c] != NONE)
+					links[b] += this->Join(c, r0, r1);
+			}
+		}
+	}, 1);
+
+	for (uint32_t b = 0; b < bands; b++) {
+		count -= links[b];
+	}
+
+	// Then the borders between the bands
+	for (uint32_t b = 1; b < bands; b++) {
+		uint32_t r = b * band;
+
+		for (uint32_t c = r * COL; c < (r + 1) * COL; c++) {
+			if (parent[c] != NONE)
+				count -= this->Join(c, r - 1, r);
+		}
+	}
+
+	// Point every cell to its root, the queries are then a comparison
+	pool.ParallelFor(ROW * COL, [this](uint32_t begin, uint32_t end, uint32_t) {
+		for (uint32_t c = begin; c < end; c++) {
+			if (parent[c] == NONE)
+				continue;
+
+			uint32_t root = c;
+
+			while (parent[root] != root)
+				root = parent[root];
+
+			parent[c] = root;
+		}
+	}, 4096);
+}
+
+void Components::Update()
+{
+	uint32_t now = maze->GetRevision();
+
+	if (built && revision == now)
+		return;
+
+	const std::vector<Maze::edit_t>& edits = maze->GetEdits();
+	bool incremental = built && revision >= maze->GetEditsBase() && now - maze->GetEditsBase() == edits.size();
+	int COL = maze->GetCols();
+
+	// Openings only join components, a new impassable cell may split one: label again
+	for (uint32_t k = incremental ? revision - maze->GetEditsBase() : 0; incremental && k < edits.size(); k++) {
+		const Maze::edit_t& e = edits[k];
+		uint32_t cell = e.cell.first * COL + e.cell.second;
+
+		bool before = Maze::getCost(e.before) != CostTable::BLOCKED;
+		bool after = Maze::getCost(e.after) != CostTable::BLOCKED;
+
+		if (!before && after) {
+			parent[cell] = cell;
+			count++;
+			count -= this->Join(cell, 0, maze->GetRows());
+		} else if (before && !after) {
+			incremental = false;
+		}
+	}
+
+	if (!incremental) {
+		this->Build();
+	}
+
+	revision = now;
+	built = true;
+}
+
+bool Components::Connected(const Pair& a, const Pair& b)
+{
+	this->Update();
+
+	if (!maze->isValid(a) || !maze->isValid(b) || !maze->isUnBlocked(a) || !maze->isUnBlocked(b))
+		return false;
+
+	int COL = maze->GetCols();
+	return this->Find(a.first * COL + a.second) == this->Find(b.first * COL + b.second);
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "maze.hpp"
+#include <vector>
+
+class Maze;
+
+// Connected components of the open cells, to reject a search that can't succeed in O(1).
+// Labelled with union-find: bands of rows are joined in parallel, then the bands are
+// merged along their borders and every cell gets the root of its component.
+// Walls opened by SetCell are joined to their neighbours without labelling again,
+// a new wall may split a component and triggers a full labelling.
+class Components
+{
+public:
+	Components(Maze* maze, Maze::moves_t moves);
+
+	// Follow the changes of the maze
+	void Update();
+
+	bool Connected(const Pair& a, const Pair& b);
+
+	uint32_t GetCount() const { return count; }
+private:
+	void Build();
+
+	// Join the open cell to its open neighbours in the rows [r0, r1), returns the number of components merged
+	uint32_t Join(uint32_t cell, uint32_t r0, uint32_t r1);
+
+	uint32_t Find(uint32_t cell);
+
+	bool Link(uint32_t a, uint32_t b);
+private:
+	Maze* maze;
+	Maze::moves_t moves;
+	uint32_t revision;
+	bool built;
+	uint32_t count;
+	std::vector<uint32_t> parent; // UINT32_MAX for the walls
+};
\ No newline at end of file
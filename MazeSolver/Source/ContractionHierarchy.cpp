@@ -0,0 +1,613 @@
+#include "ContractionHierarchy.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <functional>
+#include <cstdio>
+
+static constexpr uint32_t NONE = UINT32_MAX;
+static constexpr uint32_t MAGIC = 0x48435a4d; // "MZCH"
+static constexpr uint32_t VERSION = 3;
+static constexpr uint32_t WITNESS_LIMIT = 500; // Nodes settled by a witness search at most
+static constexpr uint32_t MAX_DEGREE = 32; // Arcs (both ways) of the nodes that can still be contracted
+
+typedef std::pair<uint32_t, uint32_t> entry_t; // <distance, node>
+
+static uint32_t Mix(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352d;
+	x ^= x >> 15;
+	x *= 0x846ca68b;
+	x ^= x >> 16;
+	return x;
+}
+
+template<typename T>
+static bool ReadArray(FILE* f, std::vector<T>& data)
+{
+	uint32_t count = 0;
+
+	if (fread(&count, sizeof(count), 1, f) != 1)
+		return false;
+
+	data.resize(count);
+	return count == 0 || fread(data.data(), sizeof(T), count, f) == count;
+}
+
+ContractionHierarchy::ContractionHierarchy(Maze* maze) : maze(maze), revision(0), built(false), shortcuts(0), core(0), settled(0), current(0)
+{
+}
+
+uint64_t ContractionHierarchy::Checksum() const
+{
+	// FNV-1a over the size, the cells and what they cost
+	uint64_t hash = 0xcbf29ce484222325ull;
+	auto add = [&hash](uint32_t value) {
+		for (int k = 0; k < 4; k++) {
+			hash ^= (value >> (8 * k)) & 0xff;
+			hash *= 0x100000001b3ull;
+		}
+	};
+
+	add(maze->GetRows());
+	add(maze->GetCols());
+
+	// Cell by cell, the same whatever the storage of the grid
+	for (int row = 0; row < maze->GetRows(); row++) {
+		for (int col = 0; col < maze->GetCols(); col++)
+			add(maze->GetMazeArray().Get(row, col));
+	}
+
+	// The same cells cost something else with another terrain
+	for (uint32_t type = 0; type < CostTable::TYPES; type++)
+		add(Maze::getCost(type));
+
+	return hash;
+}
+
+void ContractionHierarchy::Shortcuts(uint32_t x, const std::vector<std::vector<arc>>& out, const std::vector<std::vector<arc>>& in,
+	const std::vector<uint32_t>& skip, uint32_t round, workspace& ws, std::vector<std::pair<uint32_t, std::pair<uint32_t, uint32_t>>>& result) const
+{
+	result.clear();
+
+	for (const arc& a : in[x]) {
+		uint32_t u = a.to;
+		uint32_t limit = 0;
+
+		for (const arc& b : out[x]) {
+			if (b.to != u)
+				limit = std::max(limit, a.cost + b.cost);
+		}
+
+		if (limit == 0)
+			continue;
+
+		// Witness search from u without x, bounded by the longest path through x
+		if (++ws.current == 0) {
+			std::fill(ws.stamp.begin(), ws.stamp.end(), 0);
+			std::fill(ws.target.begin(), ws.target.end(), 0);
+			ws.current = 1;
+		}
+
+		// Done once the other ends of x are all settled
+		uint32_t targets = 0;
+
+		for (const arc& b : out[x]) {
+			if (b.to != u && ws.target[b.to] != ws.current) {
+				ws.target[b.to] = ws.current;
+				targets++;
+			}
+		}
+
+		uint32_t count = 0;
+		ws.openList.clear();
+		ws.dist[u] = 0;
+		ws.stamp[u] = ws.current;
+		ws.openList.push_back(entry_t(0, u));
+
+		while (!ws.openList.empty()) {
+			std::pop_heap(ws.openList.begin(), ws.openList.end(), std::greater<entry_t>());
+			uint32_t d = ws.openList.back().first;
+			uint32_t v = ws.openList.back().second;
+			ws.openList.pop_back();
+
+			if (d != ws.dist[v])
+				continue;
+
+			if (d > limit || ++count > WITNESS_LIMIT)
+				break;
+
+			if (ws.target[v] == ws.current && --targets == 0)
+				break;
+
+			for (const arc& c : out[v]) {
+				uint32_t w = c.to;
+				uint32_t nd = d + c.cost;
+
+				if (w == x || skip[w] == round || nd > limit)
+					continue;
+
+				if (ws.stamp[w] != ws.current || nd < ws.dist[w]) {
+					ws.stamp[w] = ws.current;
+					ws.dist[w] = nd;
+					ws.openList.push_back(entry_t(nd, w));
+					std::push_heap(ws.openList.begin(), ws.openList.end(), std::greater<entry_t>());
+				}
+			}
+		}
+
+		// Any distance found is the cost of an existing path, shorter ones make the shortcut useless
+		for (const arc& b : out[x]) {
+			uint32_t w = b.to;
+			uint32_t via = a.cost + b.cost;
+
+			if (w != u && (ws.stamp[w] != ws.current || ws.dist[w] > via))
+				result.push_back(std::make_pair(u, std::make_pair(w, via)));
+		}
+	}
+}
+
+void ContractionHierarchy::Build(uint32_t threads)
+{
+	int ROW = maze->GetRows();
+	int COL = maze->GetCols();
+
+	constexpr Pair coords[] = {
+		             Pair(-1, 0),
+		Pair(0, -1)             , Pair(0, 1),
+		             Pair(1, 0) ,
+	};
+
+	index.assign(ROW * COL, NONE);
+	cells.clear();
+
+	for (int c = 0; c < ROW * COL; c++) {
+		if (maze->isUnBlocked(c / COL, c % COL)) {
+			index[c] = (uint32_t)cells.size();
+			cells.push_back(c);
+		}
+	}
+
+	uint32_t N = (uint32_t)cells.size();
+	std::vector<std::vector<arc>> out(N), in(N); // Arcs between the nodes not contracted yet ('to' is the other end)
+
+	for (uint32_t n = 0; n < N; n++) {
+		int i = cells[n] / COL;
+		int j = cells[n] % COL;
+
+		for (const Pair& dir : coords) {
+			int ni = i + dir.first;
+			int nj = j + dir.second;
+
+			if (!maze->isValid(ni, nj) || !maze->isUnBlocked(ni, nj))
+				continue;
+
+			uint32_t m = index[ni * COL + nj];
+			arc a = { m, maze->getCellCost(ni, nj), NONE };
+			arc b = { n, a.cost, NONE };
+			out[n].push_back(a);
+			in[m].push_back(b);
+		}
+	}
+
+	ThreadPool pool(threads);
+	std::vector<workspace> workspaces(pool.GetThreadCount());
+
+	for (workspace& ws : workspaces) {
+		ws.dist.assign(N, 0);
+		ws.stamp.assign(N, 0);
+		ws.target.assign(N, 0);
+		ws.current = 0;
+	}
+
+	std::vector<int32_t> priority(N, 0);
+	std::vector<uint32_t> deleted(N, 0); // Neighbours already contracted
+	std::vector<uint8_t> dirty(N, 0); // Neighbours contracted since the priority was computed
+	std::vector<uint32_t> skip(N, NONE); // Round in which the node is contracted
+	std::vector<std::vector<arc>> upArcs(N), downArcs(N);
+	std::vector<uint32_t> remaining(N);
+	std::vector<uint32_t> set;
+	std::vector<std::vector<std::pair<uint32_t, std::pair<uint32_t, uint32_t>>>> found;
+
+	for (uint32_t n = 0; n < N; n++)
+		remaining[n] = n;
+
+	rank.assign(N, NONE);
+	shortcuts = 0;
+	uint32_t next = 0;
+
+	// Adds the arc u -> w, or lowers its cost if it is already there
+	auto addArc = [&](uint32_t u, uint32_t w, uint32_t cost, uint32_t mid) {
+		for (arc& a : out[u]) {
+			if (a.to != w)
+				continue;
+
+			if (cost < a.cost) {
+				a.cost = cost;
+				a.mid = mid;
+
+				for (arc& b : in[w]) {
+					if (b.to == u) {
+						b.cost = cost;
+						b.mid = mid;
+					}
+				}
+			}
+
+			return;
+		}
+
+		arc a = { w, cost, mid };
+		arc b = { u, cost, mid };
+		out[u].push_back(a);
+		in[w].push_back(b);
+		shortcuts++;
+	};
+
+	auto removeArc = [](std::vector<arc>& arcs, uint32_t to) {
+		for (uint32_t k = 0; k < arcs.size(); k++) {
+			if (arcs[k].to == to) {
+				arcs[k] = arcs.back();
+				arcs.pop_back();
+				return;
+			}
+		}
+	};
+
+	// Nodes with too many arcs wait for their neighbours, and don't hold them back
+	auto dense = [&](uint32_t x) { return in[x].size() + out[x].size() > MAX_DEGREE; };
+
+	// Edge difference (shortcuts added minus arcs removed), plus the neighbours already contracted
+	auto edgeDifference = [&](uint32_t x, size_t added) {
+		return (int32_t)added - (int32_t)in[x].size() - (int32_t)out[x].size() + (int32_t)deleted[x];
+	};
+
+	// Less important than all its neighbours, ties are broken by a hash so that even areas don't
+	// contract in a sweep from the first cell
+	auto lowest = [&](uint32_t x) {
+		for (int k = 0; k < 2; k++) {
+			for (const arc& a : (k == 0 ? out[x] : in[x])) {
+				uint32_t y = a.to;
+
+				if (!dense(y) && (priority[y] < priority[x] || (priority[y] == priority[x] && Mix(y) < Mix(x))))
+					return false;
+			}
+		}
+
+		return true;
+	};
+
+	// Every node once, then only the ones picked in a round
+	pool.ParallelFor(N, [&](uint32_t begin, uint32_t end, uint32_t thread) {
+		std::vector<std::pair<uint32_t, std::pair<uint32_t, uint32_t>>> result;
+
+		for (uint32_t x = begin; x < end; x++) {
+			this->Shortcuts(x, out, in, skip, 0, workspaces[thread], result);
+			priority[x] = edgeDifference(x, result.size());
+		}
+	}, 64);
+
+	for (uint32_t round = 1; !remaining.empty(); round++) {
+		// Nodes less important than all their neighbours, none of them are neighbours
+		set.clear();
+
+		for (uint32_t x : remaining) {
+			if (!dense(x) && lowest(x)) {
+				set.push_back(x);
+				skip[x] = round;
+			}
+		}
+
+		// What is left is the core
+		if (set.empty())
+			break;
+
+		// Their shortcuts are found in parallel, the witnesses avoid the whole set
+		found.resize(set.size());
+
+		pool.ParallelFor((uint32_t)set.size(), [&](uint32_t begin, uint32_t end, uint32_t thread) {
+			for (uint32_t i = begin; i < end; i++) {
+				this->Shortcuts(set[i], out, in, skip, round, workspaces[thread], found[i]);
+			}
+		}, 16);
+
+		for (uint32_t i = 0; i < set.size(); i++) {
+			uint32_t x = set[i];
+
+			// Lazy update: the shortcuts give the edge difference again, x waits if it's no longer the lowest
+			if (dirty[x]) {
+				priority[x] = edgeDifference(x, found[i].size());
+				dirty[x] = 0;
+
+				if (!lowest(x)) {
+					skip[x] = NONE;
+					continue;
+				}
+			}
+
+			rank[x] = next++;
+
+			// What is left around x is higher in the hierarchy
+			upArcs[x] = out[x];
+			downArcs[x] = in[x];
+
+			for (int k = 0; k < 2; k++) {
+				for (const arc& a : (k == 0 ? out[x] : in[x])) {
+					removeArc(k == 0 ? in[a.to] : out[a.to], x);
+					dirty[a.to] = 1;
+					deleted[a.to]++;
+					priority[a.to]++;
+				}
+			}
+
+			out[x].clear();
+			in[x].clear();
+
+			for (const std::pair<uint32_t, std::pair<uint32_t, uint32_t>>& s : found[i]) {
+				addArc(s.first, s.second.first, s.second.second, x);
+			}
+		}
+
+		remaining.erase(std::remove_if(remaining.begin(), remaining.end(), [this](uint32_t x) { return rank[x] != NONE; }), remaining.end());
+	}
+
+	// The core, too dense to contract: its nodes come last and keep all their arcs, the queries search it both ways
+	core = (uint32_t)remaining.size();
+
+	for (uint32_t x : remaining) {
+		rank[x] = next++;
+		upArcs[x] = out[x];
+		downArcs[x] = in[x];
+	}
+
+	upStart.assign(1, 0);
+	downStart.assign(1, 0);
+	up.clear();
+	down.clear();
+
+	for (uint32_t n = 0; n < N; n++) {
+		up.insert(up.end(), upArcs[n].begin(), upArcs[n].end());
+		down.insert(down.end(), downArcs[n].begin(), downArcs[n].end());
+		upStart.push_back((uint32_t)up.size());
+		downStart.push_back((uint32_t)down.size());
+	}
+
+	for (int k = 0; k < 2; k++) {
+		dist[k].assign(N, 0);
+		parent[k].assign(N, NONE);
+		stamp[k].assign(N, 0);
+	}
+
+	current = 0;
+	revision = maze->GetRevision();
+	built = true;
+}
+
+const ContractionHierarchy::arc* ContractionHierarchy::Find(uint32_t u, uint32_t v) const
+{
+	const arc* best = NULL;
+
+	if (rank[v] > rank[u]) {
+		for (uint32_t k = upStart[u]; k < upStart[u + 1]; k++) {
+			if (up[k].to == v && (!best || up[k].cost < best->cost))
+				best = &up[k];
+		}
+	} else {
+		for (uint32_t k = downStart[v]; k < downStart[v + 1]; k++) {
+			if (down[k].to == u && (!best || down[k].cost < best->cost))
+				best = &down[k];
+		}
+	}
+
+	return best;
+}
+
+std::stack<Pair> ContractionHierarchy::Query(const Pair& s, const Pair& t, uint32_t& cost)
+{
+	std::stack<Pair> path;
+	cost = UINT32_MAX;
+	settled = 0;
+
+	if (!built || !maze->isValid(s) || !maze->isValid(t) || !maze->isUnBlocked(s) || !maze->isUnBlocked(t))
+		return path;
+
+	int COL = maze->GetCols();
+	uint32_t S = index[s.first * COL + s.second];
+	uint32_t T = index[t.first * COL + t.second];
+
+	if (S == T) {
+		cost = 0;
+		path.push(s);
+		return path;
+	}
+
+	if (++current == 0) {
+		std::fill(stamp[0].begin(), stamp[0].end(), 0);
+		std::fill(stamp[1].begin(), stamp[1].end(), 0);
+		current = 1;
+	}
+
+	// Forward search (0) on the arcs going up from s, backward search (1) on the arcs going up from t
+	std::vector<entry_t> openList[2];
+	uint32_t best = UINT32_MAX;
+	uint32_t meet = NONE;
+
+	dist[0][S] = 0;
+	parent[0][S] = NONE;
+	stamp[0][S] = current;
+	openList[0].push_back(entry_t(0, S));
+	dist[1][T] = 0;
+	parent[1][T] = NONE;
+	stamp[1][T] = current;
+	openList[1].push_back(entry_t(0, T));
+
+	while (!openList[0].empty() || !openList[1].empty()) {
+		int side = (openList[1].empty() || (!openList[0].empty() && openList[0].front().first <= openList[1].front().first)) ? 0 : 1;
+		std::vector<entry_t>& q = openList[side];
+
+		std::pop_heap(q.begin(), q.end(), std::greater<entry_t>());
+		uint32_t d = q.back().first;
+		uint32_t v = q.back().second;
+		q.pop_back();
+
+		if (d != dist[side][v])
+			continue;
+
+		if (d >= best) { // Nothing shorter on this side
+			q.clear();
+			continue;
+		}
+
+		settled++;
+
+		const std::vector<uint32_t>& start = side == 0 ? upStart : downStart;
+		const std::vector<arc>& arcs = side == 0 ? up : down;
+
+		for (uint32_t k = start[v]; k < start[v + 1]; k++) {
+			uint32_t w = arcs[k].to;
+			uint32_t nd = d + arcs[k].cost;
+
+			if (stamp[side][w] != current || nd < dist[side][w]) {
+				stamp[side][w] = current;
+				dist[side][w] = nd;
+				parent[side][w] = v;
+				q.push_back(entry_t(nd, w));
+				std::push_heap(q.begin(), q.end(), std::greater<entry_t>());
+
+				if (stamp[1 - side][w] == current && nd + dist[1 - side][w] < best) {
+					best = nd + dist[1 - side][w];
+					meet = w;
+				}
+			}
+		}
+
+		if (stamp[1 - side][v] == current && d + dist[1 - side][v] < best) {
+			best = d + dist[1 - side][v];
+			meet = v;
+		}
+	}
+
+	if (meet == NONE)
+		return path;
+
+	cost = best;
+
+	// Nodes of the hierarchy from s to t, then every shortcut is unpacked into cells
+	std::vector<uint32_t> nodes;
+
+	for (uint32_t v = meet; v != NONE; v = parent[0][v])
+		nodes.push_back(v);
+
+	std::reverse(nodes.begin(), nodes.end());
+
+	for (uint32_t v = parent[1][meet]; v != NONE; v = parent[1][v])
+		nodes.push_back(v);
+
+	std::vector<uint32_t> route(1, S);
+	std::vector<std::pair<uint32_t, uint32_t>> stack;
+
+	for (uint32_t k = 0; k + 1 < nodes.size(); k++) {
+		stack.push_back(std::make_pair(nodes[k], nodes[k + 1]));
+
+		while (!stack.empty()) {
+			uint32_t a = stack.back().first;
+			uint32_t b = stack.back().second;
+			stack.pop_back();
+
+			const arc* e = this->Find(a, b);
+
+			if (e->mid == NONE) {
+				route.push_back(b);
+			} else {
+				stack.push_back(std::make_pair(e->mid, b));
+				stack.push_back(std::make_pair(a, e->mid));
+			}
+		}
+	}
+
+	for (std::vector<uint32_t>::reverse_iterator it = route.rbegin(); it != route.rend(); ++it)
+		path.push(Pair(cells[*it] / COL, cells[*it] % COL));
+
+	return path;
+}
+
+bool ContractionHierarchy::Save(const char* file) const
+{
+	if (!built)
+		return false;
+
+	FILE* f = fopen(file, "wb");
+
+	if (!f) {
+		printf("Can't write the contraction hierarchy to '%s'\n", file);
+		return false;
+	}
+
+	uint32_t header[4] = { MAGIC, VERSION, (uint32_t)maze->GetRows(), (uint32_t)maze->GetCols() };
+	uint64_t checksum = this->Checksum();
+	bool ok = fwrite(header, sizeof(header), 1, f) == 1 && fwrite(&checksum, sizeof(checksum), 1, f) == 1;
+
+	auto write = [&](const void* data, uint32_t size, uint32_t count) {
+		ok = ok && fwrite(&count, sizeof(count), 1, f) == 1 && (count == 0 || fwrite(data, size, count, f) == count);
+	};
+
+	write(cells.data(), sizeof(uint32_t), (uint32_t)cells.size());
+	write(rank.data(), sizeof(uint32_t), (uint32_t)rank.size());
+	write(upStart.data(), sizeof(uint32_t), (uint32_t)upStart.size());
+	write(up.data(), sizeof(arc), (uint32_t)up.size());
+	write(downStart.data(), sizeof(uint32_t), (uint32_t)downStart.size());
+	write(down.data(), sizeof(arc), (uint32_t)down.size());
+	ok = ok && fwrite(&shortcuts, sizeof(shortcuts), 1, f) == 1 && fwrite(&core, sizeof(core), 1, f) == 1;
+	fclose(f);
+
+	if (!ok)
+		printf("Can't write the contraction hierarchy to '%s'\n", file);
+
+	return ok;
+}
+
+bool ContractionHierarchy::Load(const char* file)
+{
+	FILE* f = fopen(file, "rb");
+
+	if (!f)
+		return false;
+
+	uint32_t header[4];
+	uint64_t checksum = 0;
+	bool ok = fread(header, sizeof(header), 1, f) == 1 && fread(&checksum, sizeof(checksum), 1, f) == 1;
+
+	if (!ok || header[0] != MAGIC || header[1] != VERSION || checksum != this->Checksum()) {
+		printf("The contraction hierarchy in '%s' was made for another maze\n", file);
+		fclose(f);
+		return false;
+	}
+
+	ok = ok && ReadArray(f, cells) && ReadArray(f, rank) && ReadArray(f, upStart) && ReadArray(f, up) && ReadArray(f, downStart) && ReadArray(f, down);
+	ok = ok && fread(&shortcuts, sizeof(shortcuts), 1, f) == 1 && fread(&core, sizeof(core), 1, f) == 1;
+	fclose(f);
+
+	uint32_t N = (uint32_t)cells.size();
+
+	if (!ok || rank.size() != N || upStart.size() != N + 1 || downStart.size() != N + 1) {
+		printf("Can't read the contraction hierarchy from '%s'\n", file);
+		built = false;
+		return false;
+	}
+
+	index.assign(maze->GetRows() * maze->GetCols(), NONE);
+
+	for (uint32_t n = 0; n < N; n++)
+		index[cells[n]] = n;
+
+	for (int k = 0; k < 2; k++) {
+		dist[k].assign(N, 0);
+		parent[k].assign(N, NONE);
+		stamp[k].assign(N, 0);
+	}
+
+	current = 0;
+	revision = maze->GetRevision();
+	built = true;
+	return true;
+}
\ No newline at end of file
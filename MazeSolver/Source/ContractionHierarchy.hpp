@@ -0,0 +1,91 @@
+#pragma once
+
+#include "maze.hpp"
+#include <stack>
+#include <vector>
+
+class Maze;
+
+// Contraction hierarchy over the open cells, same moves and costs as Dijkstra.
+// The cells are contracted from the least important (smallest edge difference: shortcuts
+// added minus arcs removed, plus the neighbours already contracted) to the most important,
+// adding a shortcut between two neighbours when a witness search finds no path as short
+// without the contracted cell. Every round contracts in parallel a set of cells that are
+// not neighbours. Priorities are updated lazily: a cell picked after its neighbourhood changed
+// gets its edge difference again from the shortcuts just found, and waits if it's no longer the
+// lowest. Cells with too many arcs are left as a core at the top. A query is a bidirectional
+// Dijkstra that only goes up the hierarchy, and both ways in the core.
+// The index can be saved and loaded again for the same maze.
+class ContractionHierarchy
+{
+public:
+	ContractionHierarchy(Maze* maze);
+
+	void Build(uint32_t threads = 0);
+
+	// Built (or loaded) for the maze as it is now
+	bool IsValid() const { return built && revision == maze->GetRevision(); }
+
+	bool Save(const char* file) const;
+
+	// Fails if the file is missing or was made for another maze
+	bool Load(const char* file);
+
+	// Cells from s (on top) to t, empty if there is no path. Cost is UINT32_MAX without path
+	std::stack<Pair> Query(const Pair& s, const Pair& t, uint32_t& cost);
+
+	// Nodes settled by the last query
+	uint32_t getSettled() const { return settled; }
+
+	uint32_t GetNodeCount() const { return (uint32_t)cells.size(); }
+
+	uint32_t GetShortcutCount() const { return shortcuts; }
+
+	// Nodes left uncontracted at the top
+	uint32_t GetCoreCount() const { return core; }
+private:
+	struct arc
+	{
+		uint32_t to;
+		uint32_t cost;
+		uint32_t mid; // Contracted node of a shortcut, UINT32_MAX for a move between two cells
+	};
+
+	// Witness search state of a thread
+	struct workspace
+	{
+		std::vector<uint32_t> dist;
+		std::vector<uint32_t> stamp;
+		std::vector<uint32_t> target; // Stamped for the ends the search is looking for
+		uint32_t current;
+		std::vector<std::pair<uint32_t, uint32_t>> openList;
+	};
+
+	// Shortcuts <from, <to, cost>> needed to contract x, the nodes marked with 'skip' are ignored
+	void Shortcuts(uint32_t x, const std::vector<std::vector<arc>>& out, const std::vector<std::vector<arc>>& in,
+		const std::vector<uint32_t>& skip, uint32_t round, workspace& ws, std::vector<std::pair<uint32_t, std::pair<uint32_t, uint32_t>>>& result) const;
+
+	// Arc u -> v of the hierarchy
+	const arc* Find(uint32_t u, uint32_t v) const;
+
+	uint64_t Checksum() const;
+private:
+	Maze* maze;
+	uint32_t revision;
+	bool built;
+	uint32_t shortcuts;
+	uint32_t core;
+	uint32_t settled;
+	std::vector<uint32_t> index; // Cell -> node
+	std::vector<uint32_t> cells; // Node -> cell
+	std::vector<uint32_t> rank;
+	std::vector<uint32_t> upStart; // Arcs from a node to the higher ones
+	std::vector<arc> up;
+	std::vector<uint32_t> downStart; // Arcs coming to a node from the higher ones ('to' is the higher node)
+	std::vector<arc> down;
+	// Query state, only meaningful when stamp matches the current query
+	std::vector<uint32_t> dist[2];
+	std::vector<uint32_t> parent[2];
+	std::vector<uint32_t> stamp[2];
+	uint32_t current;
+};
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "CostTable.hpp"
+#include <stdio.h>
+#include <string.h>
+
+CostTable::CostTable()
+{
+	for (uint32_t type = 0; type < TYPES; type++)
+		this->Set((uint8_t)type, BLOCKED, 0x000000, 0);
+
+	// The types of Maze::wall_t, the trace only lives while the maze is dug
+	this->Set(1, 1, 0xffffff, 51);
+	this->Set(2, 2, 0xabaeaf, 30);
+	this->Set(3, 3, 0xDBD1B4, 15);
+	this->Set(4, 4, 0xadd8e6, 5);
+	this->Set(5, BLOCKED, 0xffff00, 0);
+	this->Finish();
+}
+
+void CostTable::Set(uint8_t type, uint32_t cost, uint32_t color, uint32_t share)
+{
+	this->cost[type] = cost;
+	this->color[type] = color;
+	this->share[type] = cost != BLOCKED ? share : 0; // Walls are only dug by the generators
+	this->passable[type] = cost != BLOCKED;
+}
+
+void CostTable::Finish()
+{
+	minCost = BLOCKED;
+	maxCost = 0;
+	maxType = 5;
+	uint32_t total = 0;
+
+	for (uint32_t type = 0; type < TYPES; type++) {
+		if (!passable[type])
+			continue;
+
+		minCost = cost[type] < minCost ? cost[type] : minCost;
+		maxCost = cost[type] > maxCost ? cost[type] : maxCost;
+		total += share[type];
+		maxType = share[type] > 0 && type > maxType ? type : maxType;
+	}
+
+	// The pick p goes to the type whose shares add up past p, out of 101 picks
+	uint32_t type = 0, sum = 0;
+
+	for (uint32_t pick = 0; pick <= 100; pick++) {
+		while (type < TYPES && (sum + share[type]) * 101 <= pick * total)
+			sum += share[type++];
+
+		picks[pick] = (uint8_t)type;
+	}
+}
+
+bool CostTable::Load(const char* file)
+{
+	FILE* f = fopen(file, "r");
+
+	if (!f) {
+		printf("Can't open the terrain file '%s'\n", file);
+		return false;
+	}
+
+	CostTable table(*this);
+	char line[256];
+	uint32_t number = 0;
+	bool ok = true;
+
+	while (ok && fgets(line, sizeof(line), f)) {
+		number++;
+
+		char* comment = strchr(line, '#');
+
+		if (comment)
+			*comment = '\0';
+
+		uint32_t type, color, share;
+		char cost[16];
+		int fields = sscanf(line, "%u %15s %x %u", &type, cost, &color, &share);
+
+		if (fields <= 0)
+			continue; // Empty line
+
+		uint32_t value = BLOCKED;
+
+		if (fields != 4 || type >= TYPES || (strcmp(cost, "wall") != 0 && (sscanf(cost, "%u", &value) != 1 || value < 1 || value > MAX_COST)) || share > MAX_SHARE) {
+			printf("Line %u of '%s' isn't 'type cost|wall color share' (types up to %u, costs from 1 to %u, shares up to %u)\n", number, file, TYPES - 1, MAX_COST, MAX_SHARE);
+			ok = false;
+			break;
+		}
+
+		// Walls fill new grids and ring them, the generators mark their path with the trace
+		if (type == 0 || type == 5) {
+			printf("Line %u of '%s' redefines type %u, the walls (0) and the trace (5) can't change\n", number, file, type);
+			ok = false;
+			break;
+		}
+
+		table.Set((uint8_t)type, value, color, share);
+	}
+
+	fclose(f);
+
+	if (!ok)
+		return false;
+
+	uint32_t total = 0;
+
+	for (uint32_t type = 0; type < TYPES; type++)
+		total += table.share[type];
+
+	if (total == 0) {
+		printf("The terrain of '%s' has no type that can be crossed and generated\n", file);
+		return false;
+	}
+
+	table.Finish();
+	*this = table;
+	return true;
+}
\ No newline at end of file
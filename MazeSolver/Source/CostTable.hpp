@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+
+// Terrain of the maze, for each of the 256 cell types: whether it can be crossed, the cost of
+// entering it, its color on screen and its share of the generated cells. Lookups are a single
+// read in an array, the searches call them for every neighbour they look at.
+//
+// A terrain file overrides some types, one per line (# starts a comment):
+//     type cost|wall color share
+// e.g. "4 6 add8e6 5" makes water cost 6, "7 2 00ff00 10" adds grass. Walls (0) and the trace
+// of the generators (5) are fixed.
+class CostTable
+{
+public:
+	static constexpr uint32_t TYPES = 256;
+	static constexpr uint32_t BLOCKED = UINT32_MAX; // Cost of the types that can't be crossed
+	static constexpr uint32_t MAX_COST = 255;
+	static constexpr uint32_t MAX_SHARE = 10000;
+
+	// Walls, empty cells, stone, sand and water as they always were
+	CostTable();
+
+	// Overrides the types listed in the file, false (and the table untouched) if it can't be read
+	bool Load(const char* file);
+
+	bool IsPassable(uint8_t type) const { return passable[type] != 0; }
+
+	uint32_t GetCost(uint8_t type) const { return cost[type]; }
+
+	uint32_t GetColor(uint8_t type) const { return color[type]; }
+
+	// Type of a generated cell for a number in [0, 100], drawn following the shares
+	uint8_t GetType(uint32_t pick) const { return picks[pick]; }
+
+	// Cheapest and most expensive passable types: a distance in moves times GetMinCost() never
+	// overestimates a path, whatever the costs are
+	uint32_t GetMinCost() const { return minCost; }
+
+	uint32_t GetMaxCost() const { return maxCost; }
+
+	// Highest type a maze can hold: the built-in ones and the generated ones
+	uint32_t GetMaxType() const { return maxType; }
+
+	// 256 flags, set for the types that can be crossed
+	const uint8_t* GetPassable() const { return passable; }
+private:
+	void Set(uint8_t type, uint32_t cost, uint32_t color, uint32_t share);
+
+	// Bounds and picks after the types changed
+	void Finish();
+
+	uint32_t cost[TYPES];
+	uint32_t color[TYPES];
+	uint32_t share[TYPES];
+	uint8_t passable[TYPES];
+	uint8_t picks[101];
+	uint32_t minCost, maxCost, maxType;
+};
\ No newline at end of file
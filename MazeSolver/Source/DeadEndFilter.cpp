@@ -0,0 +1,296 @@
+#include "DeadEndFilter.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstdio>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static inline uint32_t CountBits(uint64_t x)
+{
+#if defined(_MSC_VER)
+	return (uint32_t)__popcnt64(x);
+#else
+	return (uint32_t)__builtin_popcountll(x);
+#endif
+}
+
+static inline uint32_t LowestBit(uint64_t x)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, x);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctzll(x);
+#endif
+}
+
+DeadEndFilter::DeadEndFilter(Maze* maze, Maze::moves_t moves) :
+	maze(maze), moves(moves), revision(0), built(false), rows(0), words(0), open(0), pruned(0)
+{
+}
+
+void DeadEndFilter::SetAlive(int row, int col, bool on)
+{
+	uint64_t& word = alive[row * words + col / 64];
+	word = on ? word | (1ull << (col % 64)) : word & ~(1ull << (col % 64));
+}
+
+bool DeadEndFilter::IsPruned(int row, int col) const
+{
+	if (!built || !maze->isValid(row, col) || !maze->isUnBlocked(row, col))
+		return false;
+
+	return !(alive[row * words + col / 64] & (1ull << (col % 64)));
+}
+
+uint64_t DeadEndFilter::Candidates(const uint64_t* up, const uint64_t* row, const uint64_t* down, uint32_t k) const
+{
+	// Neighbours moved onto the bit of the cell: west is the previous bit, east the next one
+	auto west = [k](const uint64_t* x) { return (x[k] << 1) | (k > 0 ? x[k - 1] >> 63 : 0); };
+	auto east = [this, k](const uint64_t* x) { return (x[k] >> 1) | (k + 1 < words ? x[k + 1] << 63 : 0); };
+
+	if (moves == Maze::MOVES_4) {
+		uint64_t n = up[k];
+		uint64_t s = down[k];
+		uint64_t w = west(row);
+		uint64_t e = east(row);
+		uint64_t two = (n & (s | w | e)) | (s & (w | e)) | (w & e); // At least two open neighbours
+
+		// Exactly one: the last cell of a branch stays, the branch is walked back to it
+		return row[k] & (n | s | w | e) & ~two;
+	}
+
+	// The neighbours touch each other unless some are on opposite sides
+	uint64_t top = west(up) | up[k] | east(up);
+	uint64_t bottom = west(down) | down[k] | east(down);
+	uint64_t left = west(up) | west(row) | west(down);
+	uint64_t right = east(up) | east(row) | east(down);
+
+	return row[k] & ~((top & bottom) | (left & right));
+}
+
+bool DeadEndFilter::FillBand(uint32_t r0, uint32_t r1, const uint64_t* top, const uint64_t* bottom)
+{
+	uint32_t cols = maze->GetCols();
+
+	auto Row = [&](int r) -> const uint64_t* {
+		if (r < 0 || r >= (int)rows)
+			return zeros.data();
+
+		if (r == (int)r0 - 1)
+			return top;
+
+		if (r == (int)r1)
+			return bottom;
+
+		return &alive[r * words];
+	};
+
+	std::vector<std::pair<uint32_t, uint32_t>> stack;
+
+	for (uint32_t r = r0; r < r1; r++) {
+		for (uint32_t k = 0; k < words; k++) {
+			uint64_t candidates = this->Candidates(Row((int)r - 1), Row(r), Row(r + 1), k);
+
+			while (candidates) {
+				stack.push_back(std::make_pair(r, k * 64 + LowestBit(candidates)));
+				candidates &= candidates - 1;
+			}
+		}
+	}
+
+	// Pruning a cell may let its neighbours go, follow them inside the band
+	bool border = false;
+
+	while (!stack.empty()) {
+		uint32_t r = stack.back().first;
+		uint32_t c = stack.back().second;
+		uint64_t bit = 1ull << (c % 64);
+		stack.pop_back();
+
+		if (!(alive[r * words + c / 64] & bit))
+			continue;
+
+		if (!(this->Candidates(Row((int)r - 1), Row(r), Row(r + 1), c / 64) & bit))
+			continue;
+
+		alive[r * words + c / 64] &= ~bit;
+		border = border || r == r0 || r == r1 - 1;
+
+		// Remember which neighbour was left: north, south, west or east
+		if (moves == Maze::MOVES_4) {
+			uint32_t d = (Row((int)r - 1)[c / 64] & bit) ? 0 : (Row(r + 1)[c / 64] & bit) ? 1 : (c > 0 && this->IsAlive(r, c - 1)) ? 2 : 3;
+
+			back[0][r * words + c / 64] |= (d & 1) ? bit : 0;
+			back[1][r * words + c / 64] |= (d & 2) ? bit : 0;
+		}
+
+		for (int dr = -1; dr <= 1; dr++) {
+			for (int dc = -1; dc <= 1; dc++) {
+				int nr = r + dr;
+				int nc = c + dc;
+
+				if (nr >= (int)r0 && nr < (int)r1 && nc >= 0 && nc < (int)cols && (alive[nr * words + nc / 64] & (1ull << (nc % 64))))
+					stack.push_back(std::make_pair(nr, nc));
+			}
+		}
+	}
+
+	return border;
+}
+
+bool DeadEndFilter::Update(const Pair& start, const Pair& end)
+{
+	bool fill = !built || revision != maze->GetRevision();
+
+	if (!fill && start == this->start && end == this->end)
+		return false;
+
+	if (fill) {
+		this->Fill();
+	} else {
+		// Back to the filled maze
+		for (const Pair& cell : reopened)
+			this->SetAlive(cell.first, cell.second, false);
+	}
+
+	reopened.clear();
+	this->start = start;
+	this->end = end;
+	this->Reopen(start);
+	this->Reopen(end);
+
+	return fill;
+}
+
+void DeadEndFilter::Reopen(const Pair& cell)
+{
+	if (!maze->isValid(cell.first, cell.second) || !maze->isUnBlocked(cell.first, cell.second))
+		return;
+
+	// On 4 directions the pruned cells are branches hanging from a cell left open: walk back up the branch
+	if (moves == Maze::MOVES_4) {
+		const int dr[4] = { -1, 1, 0, 0 };
+		const int dc[4] = { 0, 0, -1, 1 };
+
+		for (Pair c = cell; !this->IsAlive(c.first, c.second);) {
+			uint32_t i = c.first * words + c.second / 64;
+			uint32_t d = (uint32_t)(((back[0][i] >> (c.second % 64)) & 1) | (((back[1][i] >> (c.second % 64)) & 1) << 1));
+
+			this->SetAlive(c.first, c.second, true);
+			reopened.push_back(c);
+			c = Pair(c.first + dr[d], c.second + dc[d]);
+		}
+
+		return;
+	}
+
+	// On 8 directions a pruned cell may lean on several others: the whole pruned region around the cell goes back
+	const int dr[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+	const int dc[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+	std::vector<Pair> stack;
+
+	if (!this->IsAlive(cell.first, cell.second)) {
+		this->SetAlive(cell.first, cell.second, true);
+		reopened.push_back(cell);
+		stack.push_back(cell);
+	}
+
+	while (!stack.empty()) {
+		Pair c = stack.back();
+		stack.pop_back();
+
+		for (uint32_t d = 0; d < 8; d++) {
+			int r = c.first + dr[d];
+			int k = c.second + dc[d];
+
+			if (!maze->isValid(r, k) || !maze->isUnBlocked(r, k) || this->IsAlive(r, k))
+				continue;
+
+			this->SetAlive(r, k, true);
+			reopened.push_back(Pair(r, k));
+			stack.push_back(Pair(r, k));
+		}
+	}
+}
+
+void DeadEndFilter::Fill()
+{
+	uint32_t cols = maze->GetCols();
+	rows = maze->GetRows();
+	words = (cols + 63) / 64;
+	revision = maze->GetRevision();
+	built = true;
+
+	alive.assign(rows * words, 0);
+	back[0].assign(moves == Maze::MOVES_4 ? rows * words : 0, 0);
+	back[1].assign(moves == Maze::MOVES_4 ? rows * words : 0, 0);
+	zeros.assign(words, 0);
+	open = 0;
+
+	// The rows of the grid come as bitboards already
+	for (uint32_t r = 0; r < rows; r++)
+		maze->GetRowMask(r, &alive[r * words]);
+
+	for (uint64_t word : alive)
+		open += CountBits(word);
+
+	ThreadPool pool(maze->GetThreadCount());
+	uint32_t band = std::max(8u, rows / (pool.GetThreadCount() * 4));
+	uint32_t bands = (rows + band - 1) / band;
+	std::vector<uint64_t> ghosts(bands * 2 * words);
+	std::vector<uint8_t> dirty(bands, 1);
+	std::vector<uint8_t> border(bands, 0);
+	std::vector<uint32_t> todo;
+
+	while (true) {
+		todo.clear();
+
+		// Copy the rows around the bands before any of them changes
+		for (uint32_t b = 0; b < bands; b++) {
+			if (!dirty[b])
+				continue;
+
+			uint32_t r0 = b * band;
+			uint32_t r1 = std::min(rows, r0 + band);
+			const uint64_t* above = r0 > 0 ? &alive[(r0 - 1) * words] : zeros.data();
+			const uint64_t* below = r1 < rows ? &alive[r1 * words] : zeros.data();
+
+			std::copy(above, above + words, &ghosts[2 * b * words]);
+			std::copy(below, below + words, &ghosts[(2 * b + 1) * words]);
+			todo.push_back(b);
+		}
+
+		if (todo.empty())
+			break;
+
+		std::fill(border.begin(), border.end(), 0);
+
+		pool.ParallelFor((uint32_t)todo.size(), [&](uint32_t begin, uint32_t end, uint32_t) {
+			for (uint32_t i = begin; i < end; i++) {
+				uint32_t b = todo[i];
+				uint32_t r0 = b * band;
+				uint32_t r1 = std::min(rows, r0 + band);
+
+				border[b] = this->FillBand(r0, r1, &ghosts[2 * b * words], &ghosts[(2 * b + 1) * words]);
+			}
+		}, 1);
+
+		// A band is done unless the rows next to it changed
+		for (uint32_t b = 0; b < bands; b++) {
+			dirty[b] = (b > 0 && border[b - 1]) || (b + 1 < bands && border[b + 1]);
+		}
+	}
+
+	uint32_t left = 0;
+
+	for (uint64_t word : alive)
+		left += CountBits(word);
+
+	pruned = open - left;
+	printf("Dead-end filling (%s): pruned %u of %u open cells (%.1f%%)\n", moves == Maze::MOVES_4 ? "4 directions" : "8 directions",
+		pruned, open, 100.f * this->getPrunedFraction());
+}
\ No newline at end of file
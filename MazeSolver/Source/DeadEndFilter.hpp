@@ -0,0 +1,60 @@
+#pragma once
+
+#include "maze.hpp"
+#include <vector>
+
+class Maze;
+
+// Dead-end filling on bitboards (one bit per cell, 64 cells per word, rows of words).
+// A cell is pruned when it can't be on a shortest path between two other cells:
+// - on 4 directions (Dijkstra) when it has a single open neighbour,
+// - on 8 directions (A*) when its open neighbours all touch each other.
+// The rules are applied again on what is left until nothing changes. The rows are split
+// in bands filled in parallel, each band reading a copy of the rows around it, and the
+// bands are filled again while a change crosses their borders. The fill only runs again when
+// the maze changes: the pruned region around the start and the end is re-opened for each query.
+class DeadEndFilter
+{
+public:
+	DeadEndFilter(Maze* maze, Maze::moves_t moves);
+
+	// Fill again if the maze changed (returns true if it did), then re-open the start and the end
+	bool Update(const Pair& start, const Pair& end);
+
+	bool IsPruned(int row, int col) const;
+
+	bool IsPruned(const Pair& cell) const { return IsPruned(cell.first, cell.second); }
+
+	uint32_t getPrunedCount() const { return pruned; }
+
+	// Pruned cells over the open cells
+	float getPrunedFraction() const { return open > 0 ? (float)pruned / open : 0.f; }
+private:
+	// Cells of a word with the rows above and below that may be pruned
+	uint64_t Candidates(const uint64_t* up, const uint64_t* row, const uint64_t* down, uint32_t k) const;
+
+	// Fill the rows [r0, r1), returns true if a cell of the first or the last row was pruned
+	bool FillBand(uint32_t r0, uint32_t r1, const uint64_t* top, const uint64_t* bottom);
+
+	void Fill();
+
+	// Open again the pruned cells the searches need to go from the cell to the rest of the maze
+	void Reopen(const Pair& cell);
+
+	bool IsAlive(int row, int col) const { return (alive[row * words + col / 64] >> (col % 64)) & 1; }
+
+	void SetAlive(int row, int col, bool on);
+private:
+	Maze* maze;
+	Maze::moves_t moves;
+	uint32_t revision;
+	bool built;
+	Pair start, end;
+	uint32_t rows, words; // Words per row
+	std::vector<uint64_t> alive; // Open and not pruned
+	std::vector<uint64_t> back[2]; // On 4 directions, the 2 bits of the move from a pruned cell to the neighbour it left
+	std::vector<uint64_t> zeros; // Row outside of the maze
+	std::vector<Pair> reopened; // Pruned by the fill but open for the current query
+	uint32_t open;
+	uint32_t pruned;
+};
\ No newline at end of file
@@ -1,9 +1,17 @@
 #include "Dijsktra.hpp"
+#include "TreeIndex.hpp"
+#include "JunctionGraph.hpp"
+#include "DeadEndFilter.hpp"
+#include "Components.hpp"
+#include "ContractionHierarchy.hpp"
+#include "Swamps.hpp"
+#include "TransitNodes.hpp"
 #include <stack>
 #include <chrono>
 #include <thread>
 
-Dijsktra::Dijsktra(Maze* maze) : maze(maze)
+Dijsktra::Dijsktra(Maze* maze, TreeIndex* tree, JunctionGraph* junctions, DeadEndFilter* filter, Components* components, ContractionHierarchy* ch, Swamps* swamps, TransitNodes* transit) :
+	maze(maze), tree(tree), junctions(junctions), filter(filter), components(components), ch(ch), swamps(swamps), transit(transit)
 {
 
 }
@@ -26,7 +34,100 @@ uint32_t Dijsktra::minDistance(uint32_t dist[], bool shortestPathSet[], uint32_t
 
 void Dijsktra::Start(const Pair& start, const Pair& end)
 {
-	uint32_t src = start.first * (uint32_t)maze->maze[0].size() + start.second;
+	// Nothing to search if they are in different parts of the maze
+	if (components && !components->Connected(start, end)) {
+		printf("The end can't be reached\n");
+		return;
+	}
+
+	// A perfect maze has a single path between two cells, no need to search for it
+	if (tree && tree->Update()) {
+		std::stack<Pair> path = tree->Path(start, end);
+
+		if (!path.empty()) {
+			printf("Path cost: %u (tree index)\n", tree->Distance(start, end));
+			path.pop(); // The start is rendered on its own
+		} else {
+			printf("No path (tree index)\n");
+		}
+
+		this->RenderPath(start, end, path);
+		return;
+	}
+
+	// The hierarchy only goes up from both ends, a few hundred cells are settled
+	if (ch && ch->IsValid()) {
+		uint32_t cost;
+		std::stack<Pair> path = ch->Query(start, end, cost);
+
+		if (!path.empty()) {
+			printf("Path cost: %u (%u nodes settled by the contraction hierarchy)\n", cost, ch->getSettled());
+			path.pop();
+		} else {
+			printf("No path (contraction hierarchy)\n");
+		}
+
+		this->RenderPath(start, end, path);
+		return;
+	}
+
+	// Two searches around the blocks of the ends, the table of their access nodes joins them
+	if (transit && transit->Update()) {
+		uint32_t cost;
+		std::stack<Pair> path = transit->Query(start, end, cost);
+
+		if (!path.empty()) {
+			printf("Path cost: %u (%u transit table lookups)\n", cost, transit->getLookups());
+			path.pop();
+		} else {
+			printf("No path (transit nodes)\n");
+		}
+
+		this->RenderPath(start, end, path);
+		return;
+	}
+
+	// Dead ends (but the start and the end) can't be on the path
+	if (filter) {
+		filter->Update(start, end);
+	}
+
+	// And so are the regions only entered through one cell, unless the start or the end is inside
+	if (swamps) {
+		swamps->Update(start, end);
+	}
+
+	// Otherwise the corridors are skipped, the search only settles the junctions
+	if (junctions) {
+		uint32_t cost;
+		std::stack<Pair> path = junctions->Search(start, end, cost, filter, swamps);
+
+		SDL_Rect r;
+		r.w = maze->TILE_W;
+		r.h = maze->TILE_H;
+		SDL_Event event;
+
+		for (const Pair& cell : junctions->GetVisited()) {
+			SDL_SetRenderTarget(maze->renderer, maze->texture);
+			maze->ColorCase(&r, cell.first, cell.second, 0x00, 0xFF, 0x00);
+			SDL_SetRenderTarget(maze->renderer, NULL);
+			SDL_RenderCopy(maze->renderer, maze->texture, NULL, &maze->texture_sz);
+			SDL_RenderPresent(maze->renderer);
+			SDL_PollEvent(&event);
+		}
+
+		if (!path.empty()) {
+			printf("Path cost: %u (%u junctions settled out of %u)\n", cost, (uint32_t)junctions->GetVisited().size(), junctions->GetNodeCount());
+			path.pop();
+		} else {
+			printf("No path\n");
+		}
+
+		this->RenderPath(start, end, path);
+		return;
+	}
+
+	uint32_t src = start.first * (uint32_t)maze->W + start.second;
 	uint32_t V = maze->H * maze->W;
 	Graph graph = maze->ConstructGraph();
 	uint32_t* dist = new uint32_t[V]; // The result array, dist[i] will hold the shortest distance from src to i 
@@ -59,7 +160,7 @@ void Dijsktra::Start(const Pair& start, const Pair& end)
 
 		for (uint32_t v = 0; v < V; v++) { // Update dist value of the adjacent vertices of the picked vertex. 
 			// if not already in shortestPath and is next and distance isnt max and distance + cost of edge is less than already calcualted distance
-			if (!shortestPathSet[v] && graph.IsNext(u, v) && dist[u] != INT_MAX && dist[u] + graph.GetCost(u, v) < dist[v]) {
+			if (!shortestPathSet[v] && graph.IsNext(u, v) && !(filter && filter->IsPruned(v / maze->W, v % maze->W)) && !(swamps && swamps->IsSwamp(v / maze->W, v % maze->W)) && dist[u] != INT_MAX && dist[u] + graph.GetCost(u, v) < dist[v]) {
 				dist[v] = dist[u] + graph.GetCost(u, v); // Update distance
 				parent[v] = u; // set parent
 
@@ -77,15 +178,30 @@ void Dijsktra::Start(const Pair& start, const Pair& end)
 	}
 
 	// Construct the path on the stack:
-	std::stack<int> path;
-	uint32_t j = end.first * (uint32_t)maze->maze[0].size() + end.second;
+	std::stack<Pair> path;
+	uint32_t j = end.first * (uint32_t)maze->W + end.second;
 	printf("Parent : (%d, %d)\n", j, parent[j]);
 
 	while (parent[j] != -1) { // while there is a parent
-		path.emplace(j);
+		path.emplace(maze->Get2DCoord(j));
 		j = parent[j];
 	}
 
+	this->RenderPath(start, end, path);
+
+	// Clear memory
+	delete[] dist;
+	delete[] shortestPathSet;
+	delete[] parent;
+}
+
+void Dijsktra::RenderPath(const Pair& start, const Pair& end, std::stack<Pair>& path)
+{
+	SDL_Rect r;
+	r.w = maze->TILE_W;
+	r.h = maze->TILE_H;
+	SDL_Event event;
+
 	// Render start and end
 	SDL_SetRenderTarget(maze->renderer, maze->texture);
 	maze->ColorCase(&r, start.first, start.second, 0xFF, 0x0, 0x0);
@@ -96,9 +212,8 @@ void Dijsktra::Start(const Pair& start, const Pair& end)
 
 	// Rener path
 	while (!path.empty()) {
-		int p = path.top();
+		const Pair& pair = path.top();
 		SDL_SetRenderTarget(maze->renderer, maze->texture);
-		auto pair = maze->Get2DCoord(p);
 		// printf("(%d, %d)", pair.first, pair.second);
 		maze->ColorCase(&r, pair.first, pair.second, 0x00, 0x00, 0xFF);
 		maze->ColorCase(&r, start.first, start.second, 0xFF, 0x0, 0x0);
@@ -111,9 +226,4 @@ void Dijsktra::Start(const Pair& start, const Pair& end)
 		SDL_PollEvent(&event);
 		std::this_thread::sleep_for(std::chrono::milliseconds(2));
 	}
-
-	// Clear memory
-	delete[] dist;
-	delete[] shortestPathSet;
-	delete[] parent;
 }
\ No newline at end of file
@@ -1,16 +1,33 @@
 #pragma once
 #include "maze.hpp"
+#include <stack>
 
 class Maze;
+class TreeIndex;
+class JunctionGraph;
+class DeadEndFilter;
+class Components;
+class ContractionHierarchy;
+class Swamps;
+class TransitNodes;
 
 class Dijsktra
 {
 public:
-	Dijsktra(Maze* maze);
+	Dijsktra(Maze* maze, TreeIndex* tree = NULL, JunctionGraph* junctions = NULL, DeadEndFilter* filter = NULL, Components* components = NULL, ContractionHierarchy* ch = NULL, Swamps* swamps = NULL, TransitNodes* transit = NULL);
 
 	void Start(const Pair& start, const Pair& end);
 
+	void RenderPath(const Pair& start, const Pair& end, std::stack<Pair>& path);
+
 	uint32_t minDistance(uint32_t dist[], bool sptSet[], uint32_t V);
 private:
 	Maze* maze;
+	TreeIndex* tree; // Answers directly while the maze is perfect
+	JunctionGraph* junctions; // Searches over the junctions only
+	DeadEndFilter* filter; // Cells that can be skipped
+	Components* components; // Rejects the ends that can't be reached
+	ContractionHierarchy* ch; // Preprocessed shortest paths, until the maze is edited
+	Swamps* swamps; // Regions behind a single gate that can be skipped
+	TransitNodes* transit; // Distance tables between the borders of the blocks
 };
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "EllerGenerator.hpp"
+
+static constexpr uint32_t NONE = UINT32_MAX;
+
+EllerGenerator::EllerGenerator(uint32_t width, uint64_t seed) : width(width > 0 ? width : 1), rng(seed), bits(0), coins(0)
+{
+	for (uint32_t pick = 0; pick <= 100; pick++)
+		costs[pick] = (uint8_t)Maze::getCost(Maze::getRandomCell(pick));
+}
+
+uint32_t EllerGenerator::Find(uint32_t cell)
+{
+	while (parent[cell] != cell) {
+		parent[cell] = parent[parent[cell]]; // Path halving
+		cell = parent[cell];
+	}
+
+	return cell;
+}
+
+bool EllerGenerator::Coin()
+{
+	if (coins == 0) {
+		bits = rng.Next();
+		coins = 64;
+	}
+
+	bool coin = (bits & 1) != 0;
+	bits >>= 1;
+	coins--;
+	return coin;
+}
+
+uint64_t EllerGenerator::Generate(uint64_t height, const sink_t& sink)
+{
+	uint32_t COL = this->GetCols();
+	std::vector<uint8_t> cells(COL, 0), walls(COL, 0);
+	uint64_t written = 0;
+
+	parent.resize(width);
+	remaining.assign(width, 0);
+	first.assign(width, NONE);
+	next.assign(width, 0);
+
+	for (uint32_t c = 0; c < width; c++)
+		parent[c] = c;
+
+	// Top border
+	if (!sink(walls))
+		return written;
+
+	written++;
+
+	for (uint64_t row = 0; height == 0 || row < height; row++) {
+		bool last = (height != 0 && row + 1 == height);
+
+		std::fill(cells.begin(), cells.end(), 0);
+		std::fill(walls.begin(), walls.end(), 0);
+
+		// Join neighbours of different sets at random, all of them on the last row
+		uint32_t a = this->Find(0);
+		cells[1] = costs[rng(101)];
+
+		for (uint32_t c = 0; c + 1 < width; c++) {
+			uint32_t b = this->Find(c + 1);
+
+			if (a != b && (last || this->Coin())) {
+				parent[std::max(a, b)] = std::min(a, b);
+				b = std::min(a, b);
+				cells[2 * c + 2] = costs[rng(101)];
+			}
+
+			cells[2 * c + 3] = costs[rng(101)];
+			a = b;
+		}
+
+		if (!sink(cells))
+			return written;
+
+		written++;
+
+		if (last)
+			break;
+
+		// Every set goes down at least once: through its last cell if no other did
+		for (uint32_t c = 0; c < width; c++) {
+			next[c] = this->Find(c);
+			remaining[next[c]]++;
+		}
+
+		// Cells below an opening keep their set in the next row, the others are alone
+		for (uint32_t c = 0; c < width; c++) {
+			uint32_t root = next[c];
+			bool down = (--remaining[root] == 0 && first[root] == NONE) || this->Coin();
+
+			if (down) {
+				walls[2 * c + 1] = costs[rng(101)];
+
+				if (first[root] == NONE)
+					first[root] = c;
+			}
+
+			next[c] = down ? first[root] : c;
+		}
+
+		for (uint32_t c = 0; c < width; c++) {
+			parent[c] = next[c];
+			first[c] = NONE;
+		}
+
+		if (!sink(walls))
+			return written;
+
+		written++;
+	}
+
+	// Bottom border, then the unused row of Maze
+	std::fill(walls.begin(), walls.end(), 0);
+
+	for (int k = 0; k < 2; k++) {
+		if (!sink(walls))
+			return written;
+
+		written++;
+	}
+
+	return written;
+}
+
+EllerGenerator::sink_t EllerGenerator::FileSink(FILE* file)
+{
+	return [file](const std::vector<uint8_t>& row) {
+		return fwrite(row.data(), 1, row.size(), file) == row.size();
+	};
+}
\ No newline at end of file
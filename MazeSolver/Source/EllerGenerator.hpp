@@ -0,0 +1,42 @@
+#pragma once
+
+#include "maze.hpp"
+#include <functional>
+#include <cstdio>
+
+// Eller's algorithm: a perfect maze generated one row at a time, keeping only the sets of
+// the current row (O(width) memory), so the maze can be taller than memory. Rows have the
+// layout of Maze (cells on odd rows and columns, border walls, one unused column on the
+// right) with one byte per cell: the cost of entering it, 0 for a wall.
+class EllerGenerator
+{
+public:
+	// Receives every row, returns false to stop the generation
+	typedef std::function<bool(const std::vector<uint8_t>& row)> sink_t;
+
+	EllerGenerator(uint32_t width, uint64_t seed);
+
+	// Maze 'height' cells tall (0: until the sink stops), returns the number of rows written
+	uint64_t Generate(uint64_t height, const sink_t& sink);
+
+	// Bytes in a row
+	uint32_t GetCols() const { return 2 * width + 2; }
+
+	// Writes the rows to the file, stops on the first error
+	static sink_t FileSink(FILE* file);
+private:
+	uint32_t Find(uint32_t cell);
+
+	// One random bit, 64 of them per number drawn
+	bool Coin();
+private:
+	uint32_t width; // In cells
+	Random rng;
+	uint64_t bits;
+	uint32_t coins; // Bits left
+	uint8_t costs[101]; // Cost of the cell drawn for every number, as Maze::getRandomCell
+	std::vector<uint32_t> parent; // Sets of the current row
+	std::vector<uint32_t> remaining; // Cells of a set (by root) not decided yet
+	std::vector<uint32_t> first; // Cell of the set going down first, the root in the next row
+	std::vector<uint32_t> next; // Sets of the current row, then of the next one
+};
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "FlowField.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+constexpr uint8_t FlowField::NONE;
+constexpr int32_t FlowField::INF;
+
+// Moves of the agents, same as A*
+static constexpr int DIR_ROW[] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+static constexpr int DIR_COL[] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+
+FlowField::FlowField(Maze* maze) :
+	maze(maze), target(0, 0), rows(0), cols(0), offset(0), revision(0), maxCost(1), updated(0), built(false), queued(0)
+{
+}
+
+void FlowField::Build(const Pair& target)
+{
+	rows = maze->GetRows();
+	cols = maze->GetCols();
+	revision = maze->GetRevision();
+	offset = 0;
+	updated = 0;
+	maxCost = Maze::getMaxCost();
+	built = true;
+	this->target = target;
+
+	dist.assign(rows * cols, INF);
+	dir.assign(rows * cols, NONE);
+
+	// The buckets must cover the most expensive edge
+	buckets.assign(maxCost + 1, std::vector<uint32_t>());
+	queued = 0;
+
+	if (!maze->isValid(target) || !maze->isUnBlocked(target))
+		return;
+
+	dist[target.first * cols + target.second] = 0;
+	updated++;
+	this->Push(target.first * cols + target.second, 0);
+	this->Propagate();
+}
+
+// Moving the target from t to an adjacent t' costs at most cost(t') to every path: the old
+// distances plus that cost (the offset) are upper bounds, and only the cells that get strictly
+// closer than their bound have to be visited again.
+void FlowField::MoveTarget(const Pair& next)
+{
+	if (built && next == target && revision == maze->GetRevision())
+		return;
+
+	if (!built || revision != maze->GetRevision() || std::abs(next.first - target.first) > 1 || std::abs(next.second - target.second) > 1
+		|| !maze->isValid(next) || !maze->isUnBlocked(next) || !maze->isValid(target) || !maze->isUnBlocked(target) || offset > INF / 2) {
+		this->Build(next);
+		return;
+	}
+
+	uint32_t t = target.first * cols + target.second;
+	uint32_t n = next.first * cols + next.second;
+
+	updated = 0;
+	offset += (int32_t)maze->getCellCost(next.first, next.second);
+
+	// The old target now steps into the new one
+	for (uint8_t d = 0; d < 8; d++) {
+		if (target.first + DIR_ROW[d] == next.first && target.second + DIR_COL[d] == next.second)
+			dir[t] = d;
+	}
+
+	target = next;
+	dist[n] = -offset;
+	dir[n] = NONE;
+	updated++;
+	this->Push(n, 0);
+	this->Propagate();
+}
+
+void FlowField::Push(uint32_t id, uint32_t d)
+{
+	buckets[d % buckets.size()].push_back(id);
+	queued++;
+}
+
+// Dijkstra backward from the queued cells, only accepting distances that improve the current ones
+void FlowField::Propagate()
+{
+	uint32_t d = 0;
+
+	while (queued > 0) {
+		std::vector<uint32_t>& bucket = buckets[d % buckets.size()];
+
+		while (!bucket.empty()) {
+			uint32_t v = bucket.back();
+			bucket.pop_back();
+			queued--;
+
+			if ((uint32_t)(dist[v] + offset) != d) // Outdated entry
+				continue;
+
+			int row = v / cols;
+			int col = v % cols;
+			// Going from a neighbour into v costs the cost of v
+			uint32_t nd = d + maze->getCellCost(row, col);
+
+			for (uint8_t k = 0; k < 8; k++) {
+				int nrow = row + DIR_ROW[k];
+				int ncol = col + DIR_COL[k];
+
+				if (!maze->isValid(nrow, ncol) || !maze->isUnBlocked(nrow, ncol))
+					continue;
+
+				uint32_t u = nrow * cols + ncol;
+
+				if (dist[u] == INF || (uint32_t)(dist[u] + offset) > nd) {
+					dist[u] = (int32_t)nd - offset;
+					dir[u] = 7 - k; // The opposite move leads from u to v
+					updated++;
+					this->Push(u, nd);
+				}
+			}
+		}
+
+		d++;
+	}
+}
+
+Pair FlowField::GetNext(const Pair& cell) const
+{
+	uint8_t d = dir[cell.first * cols + cell.second];
+
+	if (d == NONE)
+		return cell;
+
+	return Pair(cell.first + DIR_ROW[d], cell.second + DIR_COL[d]);
+}
+
+uint32_t FlowField::GetDistance(const Pair& cell) const
+{
+	int32_t d = dist[cell.first * cols + cell.second];
+
+	if (d == INF)
+		return UINT32_MAX;
+
+	return (uint32_t)(d + offset);
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "maze.hpp"
+#include <vector>
+
+class Maze;
+
+// Distance field toward a single target, shared by any number of agents.
+// It is computed backward from the target with an integer (bucket queue) Dijkstra
+// and stores for every cell the move to take (same 8 moves as A*), so an agent
+// finds its next cell in O(1). When the target moves to an adjacent cell, the
+// field is repaired instead of being recomputed.
+class FlowField
+{
+public:
+	static constexpr uint8_t NONE = 0xff;
+
+	FlowField(Maze* maze);
+
+	// Recompute the whole field for the target
+	void Build(const Pair& target);
+
+	// Follow the target, incrementally when it moved by one cell
+	void MoveTarget(const Pair& target);
+
+	// Next cell on a cheapest path to the target (the cell itself if there is none)
+	Pair GetNext(const Pair& cell) const;
+
+	uint8_t GetDirection(const Pair& cell) const { return dir[cell.first * cols + cell.second]; }
+
+	// Cost of the cheapest path to the target, UINT32_MAX if it can't be reached
+	uint32_t GetDistance(const Pair& cell) const;
+
+	const Pair& getTarget() const { return target; }
+
+	// Number of cells whose distance was set by the last update
+	uint32_t getUpdated() const { return updated; }
+private:
+	void Push(uint32_t id, uint32_t d);
+
+	void Propagate();
+private:
+	static constexpr int32_t INF = INT32_MAX;
+
+	Maze* maze;
+	Pair target;
+	int rows, cols;
+	int32_t offset; // The distance of a cell is dist + offset
+	uint32_t revision;
+	uint32_t maxCost;
+	uint32_t updated;
+	bool built;
+	std::vector<int32_t> dist;
+	std::vector<uint8_t> dir;
+	std::vector<std::vector<uint32_t>> buckets; // Dial's circular bucket queue
+	uint32_t queued;
+};
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "GoalBounds.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include <cstdio>
+
+constexpr uint32_t GoalBounds::MAX_CELLS;
+
+static constexpr uint32_t NONE = UINT32_MAX;
+
+// Moves of A*, in the same order
+static constexpr int DIR_ROW[] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+static constexpr int DIR_COL[] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+
+typedef std::pair<uint32_t, uint32_t> entry_t; // <distance, cell>
+
+GoalBounds::GoalBounds(Maze* maze) : maze(maze), revision(0), built(false), usable(false), cols(0)
+{
+}
+
+bool GoalBounds::Update()
+{
+	if (built && revision == maze->GetRevision())
+		return usable;
+
+	auto begin = std::chrono::steady_clock::now();
+	int ROW = maze->GetRows();
+	int COL = maze->GetCols();
+	std::vector<Pair> cells;
+
+	revision = maze->GetRevision();
+	built = true;
+	usable = false;
+	cols = COL;
+	index.assign(ROW * COL, NONE);
+	boxes.clear();
+
+	for (int i = 0; i < ROW; i++) {
+		for (int j = 0; j < COL; j++) {
+			if (maze->isUnBlocked(i, j)) {
+				index[i * COL + j] = (uint32_t)cells.size();
+				cells.push_back(Pair(i, j));
+			}
+		}
+	}
+
+	uint32_t n = (uint32_t)cells.size();
+
+	if (n > MAX_CELLS || ROW > UINT16_MAX || COL > UINT16_MAX) {
+		printf("The maze has %u open cells, goal bounding handles up to %u\n", n, MAX_CELLS);
+		return false;
+	}
+
+	// Neighbours, their cost and the move leading to them, in compressed rows
+	std::vector<uint32_t> start(1, 0), next, cost;
+	std::vector<uint8_t> move;
+
+	for (const Pair& cell : cells) {
+		for (uint8_t k = 0; k < 8; k++) {
+			int ni = cell.first + DIR_ROW[k];
+			int nj = cell.second + DIR_COL[k];
+
+			if (maze->isValid(ni, nj) && index[ni * COL + nj] != NONE) {
+				next.push_back(index[ni * COL + nj]);
+				cost.push_back(maze->getCellCost(ni, nj));
+				move.push_back(k);
+			}
+		}
+
+		start.push_back((uint32_t)next.size());
+	}
+
+	box empty = { UINT16_MAX, UINT16_MAX, 0, 0 };
+	boxes.assign(n * 8, empty);
+
+	ThreadPool pool(maze->GetThreadCount());
+	uint32_t T = pool.GetThreadCount();
+	std::vector<std::vector<uint32_t>> dist(T);
+	std::vector<std::vector<uint8_t>> first(T);
+	std::vector<std::vector<entry_t>> openList(T);
+
+	pool.ParallelFor(n, [&](uint32_t begin, uint32_t end, uint32_t thread) {
+		std::vector<uint32_t>& d = dist[thread];
+		std::vector<uint8_t>& f = first[thread];
+		std::vector<entry_t>& q = openList[thread];
+
+		for (uint32_t s = begin; s < end; s++) {
+			d.assign(n, UINT32_MAX);
+			f.assign(n, 0);
+			q.clear();
+
+			d[s] = 0;
+			q.push_back(entry_t(0, s));
+
+			// Every cell inherits the first move of its parent and grows the box of that move
+			while (!q.empty()) {
+				std::pop_heap(q.begin(), q.end(), std::greater<entry_t>());
+				entry_t e = q.back();
+				q.pop_back();
+
+				if (e.first != d[e.second])
+					continue;
+
+				const Pair& cell = cells[e.second];
+
+				if (e.second != s) {
+					box& b = boxes[s * 8 + f[e.second]];
+					b.top = std::min(b.top, (uint16_t)cell.first);
+					b.left = std::min(b.left, (uint16_t)cell.second);
+					b.bottom = std::max(b.bottom, (uint16_t)cell.first);
+					b.right = std::max(b.right, (uint16_t)cell.second);
+				}
+
+				for (uint32_t k = start[e.second]; k < start[e.second + 1]; k++) {
+					uint32_t v = next[k];
+
+					if (e.first + cost[k] < d[v]) {
+						d[v] = e.first + cost[k];
+						f[v] = (e.second == s) ? move[k] : f[e.second];
+						q.push_back(entry_t(d[v], v));
+						std::push_heap(q.begin(), q.end(), std::greater<entry_t>());
+					}
+				}
+			}
+		}
+	}, 16);
+
+	usable = true;
+	printf("Goal bounding boxes of %u cells built in %.1f ms\n", n,
+		std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+	return true;
+}
+
+bool GoalBounds::Contains(int row, int col, int d, const Pair& goal) const
+{
+	uint32_t cell = index[row * cols + col];
+
+	if (!usable || cell == NONE)
+		return true;
+
+	const box& b = boxes[cell * 8 + d];
+	return goal.first >= b.top && goal.first <= b.bottom && goal.second >= b.left && goal.second <= b.right;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "maze.hpp"
+#include <vector>
+
+class Maze;
+
+// Goal bounding for A*: for every open cell and every move (the 8 moves of A*), the bounding
+// box of the cells whose cheapest path from that cell starts with that move. A search skips a
+// move whose box doesn't hold its goal, one cheapest path toward it is always left.
+// The boxes come from one Dijkstra per cell, run in parallel, and are stored on 16 bits per
+// coordinate. They are built again once the maze changed.
+class GoalBounds
+{
+public:
+	static constexpr uint32_t MAX_CELLS = 4096;
+
+	GoalBounds(Maze* maze);
+
+	// Build the boxes again if the maze changed, returns false if it has too many open cells
+	bool Update();
+
+	// May the move d (index in the moves of A*) from the cell lead to the goal ?
+	bool Contains(int row, int col, int d, const Pair& goal) const;
+private:
+	struct box
+	{
+		uint16_t top, left, bottom, right; // Empty when top > bottom
+	};
+private:
+	Maze* maze;
+	uint32_t revision;
+	bool built;
+	bool usable;
+	int cols;
+	std::vector<uint32_t> index; // Maze cell -> open cell index (UINT32_MAX for walls)
+	std::vector<box> boxes; // 8 per open cell
+};
\ No newline at end of file
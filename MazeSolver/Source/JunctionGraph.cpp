@@ -0,0 +1,343 @@
+#include "JunctionGraph.hpp"
+#include "DeadEndFilter.hpp"
+#include "Swamps.hpp"
+#include <algorithm>
+#include <functional>
+
+static constexpr uint32_t NONE = UINT32_MAX;
+
+static constexpr Pair coords[] = {
+	             Pair(-1, 0),
+	Pair(0, -1)             , Pair(0, 1),
+	             Pair(1, 0) ,
+};
+
+JunctionGraph::JunctionGraph(Maze* maze) : maze(maze), revision(0), built(false), COL(0), current(0)
+{
+}
+
+void JunctionGraph::Update()
+{
+	if (!built || revision != maze->GetRevision()) {
+		this->Build();
+	}
+}
+
+uint32_t JunctionGraph::Degree(int row, int col)
+{
+	uint32_t degree = 0;
+
+	for (const Pair& dir : coords) {
+		if (maze->isValid(row + dir.first, col + dir.second) && maze->isUnBlocked(row + dir.first, col + dir.second))
+			degree++;
+	}
+
+	return degree;
+}
+
+uint32_t JunctionGraph::Cost(const edge& e, uint32_t a, uint32_t b) const
+{
+	return prefix[e.begin + b] - (a > 0 ? prefix[e.begin + a - 1] : 0);
+}
+
+void JunctionGraph::AddNode(uint32_t cell)
+{
+	node[cell] = (uint32_t)nodeCell.size();
+	nodeCell.push_back(cell);
+	adjacency.push_back(std::vector<uint32_t>());
+}
+
+// Follow the corridor leaving node u by the cell 'first' until the next node
+void JunctionGraph::Walk(uint32_t u, uint32_t first)
+{
+	std::vector<uint32_t> cells;
+	uint32_t prev = u;
+	uint32_t cur = first;
+
+	while (node[cur] == NONE) {
+		cells.push_back(cur);
+		uint32_t next = NONE;
+
+		for (const Pair& dir : coords) {
+			int ni = cur / COL + dir.first;
+			int nj = cur % COL + dir.second;
+
+			if (maze->isValid(ni, nj) && maze->isUnBlocked(ni, nj) && (uint32_t)(ni * COL + nj) != prev) {
+				next = ni * COL + nj;
+				break;
+			}
+		}
+
+		prev = cur;
+		cur = next;
+	}
+
+	// Every corridor is walked from both ends, only one of them adds it
+	uint32_t last = cells.empty() ? u : cells.back();
+
+	if (std::make_pair(u, first) > std::make_pair(cur, last))
+		return;
+
+	edge e;
+	e.from = node[u];
+	e.to = node[cur];
+	e.begin = (uint32_t)corridor.size();
+	e.length = (uint32_t)cells.size();
+
+	uint32_t sum = 0;
+
+	for (uint32_t k = 0; k < cells.size(); k++) {
+		sum += maze->getCellCost(cells[k] / COL, cells[k] % COL);
+		edgeOf[cells[k]] = (uint32_t)edges.size();
+		offset[cells[k]] = k;
+		corridor.push_back(cells[k]);
+		prefix.push_back(sum);
+	}
+
+	e.forward = sum + maze->getCellCost(cur / COL, cur % COL);
+	e.backward = sum + maze->getCellCost(u / COL, u % COL);
+
+	adjacency[e.from].push_back((uint32_t)edges.size());
+
+	if (e.to != e.from)
+		adjacency[e.to].push_back((uint32_t)edges.size());
+
+	edges.push_back(e);
+}
+
+void JunctionGraph::Build()
+{
+	int ROW = maze->GetRows();
+	COL = maze->GetCols();
+	uint32_t V = ROW * COL;
+
+	revision = maze->GetRevision();
+	built = true;
+	node.assign(V, NONE);
+	edgeOf.assign(V, NONE);
+	offset.assign(V, 0);
+	nodeCell.clear();
+	corridor.clear();
+	prefix.clear();
+	edges.clear();
+	adjacency.clear();
+
+	for (uint32_t c = 0; c < V; c++) {
+		if (maze->isUnBlocked(c / COL, c % COL) && this->Degree(c / COL, c % COL) != 2)
+			this->AddNode(c);
+	}
+
+	auto walkFrom = [this](uint32_t c) {
+		for (const Pair& dir : coords) {
+			int ni = c / COL + dir.first;
+			int nj = c % COL + dir.second;
+
+			if (maze->isValid(ni, nj) && maze->isUnBlocked(ni, nj))
+				this->Walk(c, ni * COL + nj);
+		}
+	};
+
+	// Corridors between junctions and dead ends first, every one of their cells is then on an edge
+	for (uint32_t n = 0, junctions = (uint32_t)nodeCell.size(); n < junctions; n++)
+		walkFrom(nodeCell[n]);
+
+	// What is left are corridors closed on themselves, one of their cells becomes a node
+	for (uint32_t c = 0; c < V; c++) {
+		if (node[c] != NONE || edgeOf[c] != NONE || !maze->isUnBlocked(c / COL, c % COL))
+			continue;
+
+		this->AddNode(c);
+		walkFrom(c);
+	}
+
+	dist.assign(nodeCell.size(), UINT32_MAX);
+	parentEdge.assign(nodeCell.size(), NONE);
+	parentSide.assign(nodeCell.size(), 0);
+	fromStart.assign(nodeCell.size(), 0);
+	stamp.assign(nodeCell.size(), 0);
+	current = 0;
+}
+
+std::stack<Pair> JunctionGraph::Search(const Pair& s, const Pair& t, uint32_t& cost, const DeadEndFilter* filter, const Swamps* swamps)
+{
+	std::stack<Pair> path;
+	cost = UINT32_MAX;
+	visited.clear();
+
+	this->Update();
+
+	if (!maze->isValid(s) || !maze->isValid(t) || !maze->isUnBlocked(s) || !maze->isUnBlocked(t))
+		return path;
+
+	uint32_t S = s.first * COL + s.second;
+	uint32_t T = t.first * COL + t.second;
+
+	if (S == T) {
+		cost = 0;
+		path.push(s);
+		return path;
+	}
+
+	if (++current == 0) {
+		std::fill(stamp.begin(), stamp.end(), 0);
+		current = 1;
+	}
+
+	std::vector<std::pair<uint32_t, uint32_t>> openList; // <distance, node>
+
+	auto relax = [&](uint32_t n, uint32_t d, uint32_t e, uint8_t side, uint8_t start) {
+		if ((filter && filter->IsPruned(this->ToPair(nodeCell[n]))) || (swamps && swamps->IsSwamp(this->ToPair(nodeCell[n]))))
+			return;
+
+		if (stamp[n] != current || d < dist[n]) {
+			stamp[n] = current;
+			dist[n] = d;
+			parentEdge[n] = e;
+			parentSide[n] = side;
+			fromStart[n] = start;
+			openList.push_back(std::make_pair(d, n));
+			std::push_heap(openList.begin(), openList.end(), std::greater<std::pair<uint32_t, uint32_t>>());
+		}
+	};
+
+	uint32_t best = UINT32_MAX;
+	uint32_t bestNode = NONE;
+	uint8_t bestSide = 0;
+	bool direct = false; // Start and end in the same corridor, without going through a node
+
+	if (node[S] != NONE) {
+		relax(node[S], 0, NONE, 0, 0);
+	} else {
+		const edge& e = edges[edgeOf[S]];
+		uint32_t k = offset[S];
+
+		relax(e.from, (k > 0 ? this->Cost(e, 0, k - 1) : 0) + maze->getCellCost(nodeCell[e.from] / COL, nodeCell[e.from] % COL), edgeOf[S], 0, 1);
+		relax(e.to, (k + 1 < e.length ? this->Cost(e, k + 1, e.length - 1) : 0) + maze->getCellCost(nodeCell[e.to] / COL, nodeCell[e.to] % COL), edgeOf[S], 1, 1);
+
+		if (node[T] == NONE && edgeOf[T] == edgeOf[S]) {
+			best = offset[T] > k ? this->Cost(e, k + 1, offset[T]) : this->Cost(e, offset[T], k - 1);
+			direct = true;
+		}
+	}
+
+	while (!openList.empty()) {
+		std::pop_heap(openList.begin(), openList.end(), std::greater<std::pair<uint32_t, uint32_t>>());
+		uint32_t d = openList.back().first;
+		uint32_t x = openList.back().second;
+		openList.pop_back();
+
+		if (d != dist[x])
+			continue;
+
+		if (d >= best)
+			break;
+
+		visited.push_back(this->ToPair(nodeCell[x]));
+
+		if (node[T] == x) {
+			best = d;
+			bestNode = x;
+			direct = false;
+			break;
+		}
+
+		// The end is inside a corridor, finish through one of its ends
+		if (node[T] == NONE) {
+			const edge& e = edges[edgeOf[T]];
+
+			if (e.from == x && d + this->Cost(e, 0, offset[T]) < best) {
+				best = d + this->Cost(e, 0, offset[T]);
+				bestNode = x;
+				bestSide = 0;
+				direct = false;
+			}
+
+			if (e.to == x && d + this->Cost(e, offset[T], e.length - 1) < best) {
+				best = d + this->Cost(e, offset[T], e.length - 1);
+				bestNode = x;
+				bestSide = 1;
+				direct = false;
+			}
+		}
+
+		for (uint32_t id : adjacency[x]) {
+			const edge& e = edges[id];
+
+			if (e.from == x)
+				relax(e.to, d + e.forward, id, 1, 0);
+
+			if (e.to == x)
+				relax(e.from, d + e.backward, id, 0, 0);
+		}
+	}
+
+	if (best == UINT32_MAX)
+		return path;
+
+	cost = best;
+
+	// Build the path from the end back to the start
+	if (direct) {
+		const edge& e = edges[edgeOf[S]];
+		int ks = (int)offset[S];
+		int kt = (int)offset[T];
+
+		if (kt > ks) {
+			for (int k = kt; k > ks; k--)
+				path.push(this->ToPair(corridor[e.begin + k]));
+		} else {
+			for (int k = kt; k < ks; k++)
+				path.push(this->ToPair(corridor[e.begin + k]));
+		}
+
+		path.push(s);
+		return path;
+	}
+
+	if (node[T] == NONE) {
+		const edge& e = edges[edgeOf[T]];
+		int kt = (int)offset[T];
+
+		if (bestSide == 0) {
+			for (int k = kt; k >= 0; k--)
+				path.push(this->ToPair(corridor[e.begin + k]));
+		} else {
+			for (int k = kt; k < (int)e.length; k++)
+				path.push(this->ToPair(corridor[e.begin + k]));
+		}
+	}
+
+	uint32_t x = bestNode;
+
+	while (true) {
+		path.push(this->ToPair(nodeCell[x]));
+
+		if (parentEdge[x] == NONE)
+			break;
+
+		const edge& e = edges[parentEdge[x]];
+		bool seed = fromStart[x] != 0; // Left the start inside this corridor
+		int ks = seed ? (int)offset[S] : -1;
+
+		if (parentSide[x] == 1) { // Came along the corridor from its 'from' end
+			for (int k = (int)e.length - 1; k > ks; k--)
+				path.push(this->ToPair(corridor[e.begin + k]));
+
+			x = e.from;
+		} else {
+			int end = seed ? ks : (int)e.length;
+
+			for (int k = 0; k < end; k++)
+				path.push(this->ToPair(corridor[e.begin + k]));
+
+			x = e.to;
+		}
+
+		if (seed) {
+			path.push(s);
+			break;
+		}
+	}
+
+	return path;
+}
\ No newline at end of file
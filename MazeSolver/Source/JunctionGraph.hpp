@@ -0,0 +1,77 @@
+#pragma once
+
+#include "maze.hpp"
+#include <stack>
+#include <vector>
+
+class Maze;
+class DeadEndFilter;
+class Swamps;
+
+// The maze with its corridors contracted, same moves as Dijkstra.
+// Nodes are the open cells without exactly 2 open neighbours (junctions and dead ends),
+// every corridor between two of them becomes one edge weighted in both directions with
+// the cost of the cells it enters. Searches run on these nodes only, a start or an end
+// inside a corridor enters through both of its ends, and the corridors are expanded back
+// to cells for the final path.
+class JunctionGraph
+{
+public:
+	JunctionGraph(Maze* maze);
+
+	// Rebuild if the maze changed
+	void Update();
+
+	// Cells from s (on top) to t, empty if there is no path. Cost is UINT32_MAX without path.
+	// The junctions pruned by the filter or in a swamp are skipped
+	std::stack<Pair> Search(const Pair& s, const Pair& t, uint32_t& cost, const DeadEndFilter* filter = NULL, const Swamps* swamps = NULL);
+
+	// Junctions settled by the last search
+	const std::vector<Pair>& GetVisited() const { return visited; }
+
+	uint32_t GetNodeCount() const { return (uint32_t)nodeCell.size(); }
+
+	uint32_t GetEdgeCount() const { return (uint32_t)edges.size(); }
+private:
+	// A corridor, its cells run from the 'from' node to the 'to' node
+	struct edge
+	{
+		uint32_t from, to;
+		uint32_t forward, backward; // Cost from -> to and to -> from
+		uint32_t begin, length; // Cells in corridor[begin, begin + length)
+	};
+
+	void Build();
+
+	void AddNode(uint32_t cell);
+
+	void Walk(uint32_t u, uint32_t first);
+
+	uint32_t Degree(int row, int col);
+
+	// Cost of the cells [a, b] of a corridor
+	uint32_t Cost(const edge& e, uint32_t a, uint32_t b) const;
+
+	Pair ToPair(uint32_t cell) const { return Pair(cell / COL, cell % COL); }
+private:
+	Maze* maze;
+	uint32_t revision;
+	bool built;
+	int COL;
+	std::vector<uint32_t> node; // Cell -> node, UINT32_MAX inside the corridors and the walls
+	std::vector<uint32_t> nodeCell;
+	std::vector<uint32_t> edgeOf; // Corridor cell -> edge
+	std::vector<uint32_t> offset; // Corridor cell -> position in its edge
+	std::vector<uint32_t> corridor;
+	std::vector<uint32_t> prefix; // Sum of the costs from the beginning of the corridor
+	std::vector<edge> edges;
+	std::vector<std::vector<uint32_t>> adjacency; // Node -> edges
+	// Search state, only meaningful when stamp matches the current search
+	std::vector<uint32_t> dist;
+	std::vector<uint32_t> parentEdge;
+	std::vector<uint8_t> parentSide; // 1 if reached by the 'to' end of the parent edge
+	std::vector<uint8_t> fromStart; // The parent edge is the one of the start
+	std::vector<uint32_t> stamp;
+	uint32_t current;
+	std::vector<Pair> visited;
+};
\ No newline at end of file
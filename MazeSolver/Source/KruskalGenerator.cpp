@@ -0,0 +1,216 @@
+#include "KruskalGenerator.hpp"
+#include "ThreadPool.hpp"
+
+// SplitMix64 finalizer, the random key of a wall or a cell only depends on the seed
+static uint64_t Mix(uint64_t x)
+{
+	x += 0x9e3779b97f4a7c15ull;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+	return x ^ (x >> 31);
+}
+
+// Cell type drawn from a random number, as Maze::getRandomCell
+static uint32_t RandomCell(uint64_t r)
+{
+	return Maze::getRandomCell((uint32_t)(((r >> 32) * 101) >> 32));
+}
+
+KruskalGenerator::KruskalGenerator(Maze* maze) : maze(maze)
+{
+}
+
+uint32_t KruskalGenerator::Find(uint32_t cell)
+{
+	uint32_t p = parent[cell].load(std::memory_order_relaxed);
+
+	while (p != cell) {
+		uint32_t grand = parent[p].load(std::memory_order_relaxed);
+
+		// Path halving, losing the race only leaves a longer path
+		parent[cell].compare_exchange_weak(p, grand, std::memory_order_relaxed);
+		cell = grand;
+		p = parent[cell].load(std::memory_order_relaxed);
+	}
+
+	return cell;
+}
+
+void KruskalGenerator::Build(uint64_t seed, uint32_t threads)
+{
+	Maze::MazeArray& grid = maze->GetMazeArray();
+	int ROW = maze->GetRows();
+	int COL = maze->GetCols();
+
+	// Cells on the odd rows and columns, as Maze::BuildMaze
+	uint32_t cellRows = ROW > 2 ? (ROW - 1) / 2 : 0;
+	uint32_t cellCols = COL > 2 ? (COL - 1) / 2 : 0;
+	uint32_t cells = cellRows * cellCols;
+
+	if (cells == 0)
+		return;
+
+	ThreadPool pool(threads);
+	uint32_t T = pool.GetThreadCount();
+
+	parent = std::vector<std::atomic<uint32_t>>(cells);
+
+	// Bands of rows as high as the tiles of the grid: cells of the same word can't be written by two threads
+	uint32_t bands = (ROW + CellGrid::TILE - 1) / CellGrid::TILE;
+
+	pool.ParallelFor(bands, [&](uint32_t begin, uint32_t end, uint32_t) {
+		for (uint32_t r = begin * CellGrid::TILE; r < end * CellGrid::TILE; r++) {
+			if (r % 2 == 0 || (r - 1) / 2 >= cellRows)
+				continue;
+
+			for (uint32_t c = (r - 1) / 2 * cellCols; c < (r + 1) / 2 * cellCols; c++) {
+				parent[c].store(c, std::memory_order_relaxed);
+				grid.Set(r, 2 * (c % cellCols) + 1, RandomCell(Mix(seed ^ Mix(c))));
+			}
+		}
+	}, 2);
+
+	auto key = [seed](uint64_t wall) {
+		return wall | (Mix(seed + 1 + wall) & 0xffffffff00000000ull);
+	};
+
+	// Walls <key, wall>: wall 2 * c is right of the cell c, 2 * c + 1 below it
+	std::vector<uint64_t> walls;
+	walls.reserve(2 * (size_t)cells);
+
+	for (uint32_t c = 0; c < cells; c++) {
+		if (c % cellCols + 1 < cellCols)
+			walls.push_back(2 * c);
+
+		if (c / cellCols + 1 < cellRows)
+			walls.push_back(2 * c + 1);
+	}
+
+	uint32_t count = (uint32_t)walls.size();
+	uint32_t chunk = (count + T - 1) / T;
+
+	// Keys and sort in ranges, one per thread, then merged two by two
+	pool.ParallelFor(T, [&](uint32_t begin, uint32_t end, uint32_t) {
+		for (uint32_t t = begin; t < end; t++) {
+			uint32_t first = std::min(count, t * chunk);
+			uint32_t last = std::min(count, first + chunk);
+
+			for (uint32_t i = first; i < last; i++)
+				walls[i] = key(walls[i]);
+
+			std::sort(walls.begin() + first, walls.begin() + last);
+		}
+	}, 1);
+
+	for (uint32_t width = chunk; width < count; width *= 2) {
+		uint32_t merges = (count + 2 * width - 1) / (2 * width);
+
+		pool.ParallelFor(merges, [&](uint32_t begin, uint32_t end, uint32_t) {
+			for (uint32_t m = begin; m < end; m++) {
+				uint32_t first = m * 2 * width;
+				uint32_t middle = std::min(count, first + width);
+				uint32_t last = std::min(count, first + 2 * width);
+				std::inplace_merge(walls.begin() + first, walls.begin() + middle, walls.begin() + last);
+			}
+		}, 1);
+	}
+
+	// Deterministic reservations: the walls are taken in sorted order by rounds of a window. Every wall
+	// of the window that still joins two sets reserves both roots with its rank, the lowest rank wins;
+	// a wall links a root it won under the other one, the others wait for the next round. A wall is
+	// only opened when no wall before it touches one of its sets, so the maze is the one of the
+	// sequential Kruskal with any number of threads.
+	std::vector<uint8_t> opened(2 * (size_t)cells, 0);
+	std::vector<std::atomic<uint32_t>> reserved(cells);
+	std::vector<uint32_t> window;
+	std::vector<std::pair<uint32_t, uint32_t>> roots;
+	uint32_t size = 4096 * T; // Windows of a few thousand walls per thread keep the roots they touch in cache
+	uint32_t taken = 0;
+
+	for (uint32_t c = 0; c < cells; c++)
+		reserved[c].store(UINT32_MAX, std::memory_order_relaxed);
+
+	while (taken < count || !window.empty()) {
+		while (window.size() < size && taken < count)
+			window.push_back(taken++);
+
+		uint32_t pending = (uint32_t)window.size();
+		roots.resize(pending);
+
+		pool.ParallelFor(pending, [&](uint32_t begin, uint32_t end, uint32_t) {
+			for (uint32_t i = begin; i < end; i++) {
+				uint32_t wall = (uint32_t)walls[window[i]];
+				uint32_t c = wall / 2;
+				uint32_t a = this->Find(c);
+				uint32_t b = this->Find((wall & 1) ? c + cellCols : c + 1);
+				roots[i] = std::make_pair(a, b);
+
+				if (a == b)
+					continue;
+
+				for (uint32_t root : { a, b }) {
+					uint32_t rank = reserved[root].load(std::memory_order_relaxed);
+
+					while (window[i] < rank && !reserved[root].compare_exchange_weak(rank, window[i], std::memory_order_relaxed));
+				}
+			}
+		}, 0);
+
+		// A root is linked by the wall that won it only, and a cycle would need ranks lower all around
+		pool.ParallelFor(pending, [&](uint32_t begin, uint32_t end, uint32_t) {
+			for (uint32_t i = begin; i < end; i++) {
+				uint32_t a = roots[i].first;
+				uint32_t b = roots[i].second;
+
+				if (a == b)
+					continue;
+
+				if (reserved[b].load(std::memory_order_relaxed) == window[i])
+					parent[b].store(a, std::memory_order_relaxed);
+				else if (reserved[a].load(std::memory_order_relaxed) == window[i])
+					parent[a].store(b, std::memory_order_relaxed);
+				else
+					continue;
+
+				opened[(uint32_t)walls[window[i]]] = 1;
+			}
+		}, 0);
+
+		pool.ParallelFor(pending, [&](uint32_t begin, uint32_t end, uint32_t) {
+			for (uint32_t i = begin; i < end; i++) {
+				reserved[roots[i].first].store(UINT32_MAX, std::memory_order_relaxed);
+				reserved[roots[i].second].store(UINT32_MAX, std::memory_order_relaxed);
+			}
+		}, 0);
+
+		// The walls that lost keep their order at the front of the next window
+		uint32_t kept = 0;
+
+		for (uint32_t i = 0; i < pending; i++) {
+			if (roots[i].first != roots[i].second && !opened[(uint32_t)walls[window[i]]])
+				window[kept++] = window[i];
+		}
+
+		window.resize(kept);
+	}
+
+	// The opened walls are written by the same bands: on odd rows the walls right of the cells, on even ones the walls below the cells above
+	pool.ParallelFor(bands, [&](uint32_t begin, uint32_t end, uint32_t) {
+		for (uint32_t r = std::max(1u, begin * CellGrid::TILE); r < end * CellGrid::TILE; r++) {
+			uint32_t row = (r - 1) / 2;
+
+			if (row >= cellRows)
+				break;
+
+			for (uint32_t c = row * cellCols; c < (row + 1) * cellCols; c++) {
+				uint32_t wall = 2 * c + (r % 2 == 0);
+
+				if (opened[wall])
+					grid.Set(r, 2 * (c % cellCols) + 1 + (r % 2), RandomCell(Mix(key(wall))));
+			}
+		}
+	}, 2);
+
+	parent.clear();
+	parent.shrink_to_fit();
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "maze.hpp"
+#include <atomic>
+
+class Maze;
+
+// Randomized Kruskal over the cells: the walls between two cells are sorted by a random key
+// (keys drawn and sorted in parallel) and a wall is opened when it joins two different sets.
+// The threads take the sorted walls by windows: each wall reserves the roots of both its sets
+// in a lock-free union-find (path halving), a root goes to the first wall in the order, which
+// links it under the other root; the walls that won no root wait for the next window. A wall is
+// opened in the same cases as in the sequential Kruskal, so the maze only depends on the seed,
+// whatever the number of threads.
+class KruskalGenerator
+{
+public:
+	KruskalGenerator(Maze* maze);
+
+	// Fill a maze made of walls only
+	void Build(uint64_t seed, uint32_t threads = 0);
+private:
+	uint32_t Find(uint32_t cell);
+private:
+	Maze* maze;
+	std::vector<std::atomic<uint32_t>> parent;
+};
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "LRTAStar.hpp"
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+
+LRTAStar::LRTAStar(Maze* maze, uint32_t budget) : maze(maze), budget(1), expansions(0), stamp(0), drift(0), revision(0)
+{
+	this->setBudget(budget);
+	this->Reset();
+}
+
+void LRTAStar::Reset()
+{
+	uint32_t V = maze->GetRows() * maze->GetCols();
+	node n = { UINT32_MAX, 0, 0, false };
+
+	nodes.assign(V, n);
+	learned.assign(V, 0);
+	openList.reserve(8 * budget + 1);
+	closedList.reserve(budget);
+	stamp = 0;
+	drift = 0;
+	revision = maze->GetRevision();
+}
+
+// Chebyshev distance times the cheapest cell, raised by what has been learned
+uint32_t LRTAStar::calculateHValue(uint32_t id, const Pair& target)
+{
+	int COL = maze->GetCols();
+	int row = id / COL;
+	int col = id % COL;
+	uint32_t h = (uint32_t)std::max(std::abs(row - target.first), std::abs(col - target.second)) * Maze::getMinCost();
+
+	if (learned[id] > drift && learned[id] - drift > h)
+		h = learned[id] - drift;
+
+	return h;
+}
+
+// If d(s, from) >= h(s) and the target moved to an adjacent cell then d(s, to) >= h(s) - cost(from),
+// so shifting every learned value by the cost of the old cell keeps them admissible in O(1).
+void LRTAStar::TargetMoved(const Pair& from, const Pair& to)
+{
+	if (from == to)
+		return;
+
+	if (std::abs(from.first - to.first) > 1 || std::abs(from.second - to.second) > 1 || !maze->isValid(from) || !maze->isUnBlocked(from)) {
+		this->Reset(); // The target jumped, nothing learned can be trusted
+		return;
+	}
+
+	drift += maze->getCellCost(from.first, from.second);
+}
+
+bool LRTAStar::Step(const Pair& agent, const Pair& target, Pair& next)
+{
+	int COL = maze->GetCols();
+
+	// All directions to check (same moves as A*):
+	constexpr Pair coords[] = {
+		Pair(-1, -1), Pair(-1, 0), Pair(-1, 1),
+		Pair(0, -1)              , Pair(0, 1),
+		Pair(1, -1), Pair(1, 0)  , Pair(1, 1),
+	};
+
+	next = agent;
+	expansions = 0;
+
+	if (revision != maze->GetRevision()) // The maze changed, the learned values may be wrong
+		this->Reset();
+
+	if (!maze->isValid(agent) || !maze->isValid(target) || !maze->isUnBlocked(agent) || !maze->isUnBlocked(target))
+		return false;
+
+	if (agent == target)
+		return true;
+
+	// New search: bump the stamp instead of clearing the state of every cell
+	if (++stamp == 0) {
+		for (node& n : nodes)
+			n.stamp = 0;
+
+		stamp = 1;
+	}
+
+	uint32_t src = agent.first * COL + agent.second;
+	uint32_t dest = target.first * COL + target.second;
+	uint32_t best = UINT32_MAX;
+
+	openList.clear();
+	closedList.clear();
+	nodes[src].g = 0;
+	nodes[src].parent = src;
+	nodes[src].stamp = stamp;
+	nodes[src].closed = false;
+	openList.push_back(openEntry(calculateHValue(src, target), std::make_pair(0, src)));
+
+	while (!openList.empty()) {
+		std::pop_heap(openList.begin(), openList.end(), std::greater<openEntry>());
+		openEntry p = openList.back();
+		openList.pop_back();
+
+		uint32_t id = p.second.second;
+		node& n = nodes[id];
+
+		if (n.closed || p.second.first != n.g) // Outdated entry
+			continue;
+
+		// Stop on the target or when the budget is spent: this cell is the best of the frontier
+		if (id == dest || expansions == budget) {
+			best = id;
+			break;
+		}
+
+		n.closed = true;
+		closedList.push_back(id);
+		expansions++;
+
+		int i = id / COL;
+		int j = id % COL;
+
+		for (const Pair& dir : coords) {
+			int ni = i + dir.first;
+			int nj = j + dir.second;
+
+			if (maze->isValid(ni, nj) == false || maze->isUnBlocked(ni, nj) == false)
+				continue;
+
+			uint32_t nid = ni * COL + nj;
+			node& m = nodes[nid];
+			uint32_t newG = n.g + maze->getCellCost(ni, nj);
+
+			if (m.stamp != stamp) {
+				m.stamp = stamp;
+				m.g = UINT32_MAX;
+				m.closed = false;
+			}
+
+			if (!m.closed && newG < m.g) {
+				m.g = newG;
+				m.parent = id;
+				openList.push_back(openEntry(newG + calculateHValue(nid, target), std::make_pair(newG, nid)));
+				std::push_heap(openList.begin(), openList.end(), std::greater<openEntry>());
+			}
+		}
+	}
+
+	if (best == UINT32_MAX) // Everything reachable was expanded without meeting the target
+		return false;
+
+	// Learning: h(s) = f(best) - g(s) for every expanded cell
+	uint32_t f = nodes[best].g + calculateHValue(best, target);
+
+	for (uint32_t id : closedList) {
+		if (f > nodes[id].g)
+			learned[id] = std::max(learned[id], f - nodes[id].g + drift);
+	}
+
+	// Move one cell along the path to the best frontier cell
+	uint32_t id = best;
+
+	while (nodes[id].parent != src)
+		id = nodes[id].parent;
+
+	next = Pair(id / COL, id % COL);
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "maze.hpp"
+#include <vector>
+
+class Maze;
+
+// Real-time heuristic search agent (RTAA* flavour of LRTA*).
+// Every call to Step runs an A* that stops after a fixed number of expansions,
+// raises the heuristic of the expanded cells and moves the agent by one cell,
+// so the cost of a step depends on the budget and never on the maze size.
+class LRTAStar
+{
+public:
+	LRTAStar(Maze* maze, uint32_t budget = 64);
+
+	// Compute the next cell of the agent, returns false if the target can't be reached
+	bool Step(const Pair& agent, const Pair& target, Pair& next);
+
+	// Keep the learned values admissible when the target moves by one cell
+	void TargetMoved(const Pair& from, const Pair& to);
+
+	// Forget everything that has been learned
+	void Reset();
+
+	void setBudget(uint32_t budget) { this->budget = budget > 0 ? budget : 1; }
+
+	uint32_t getBudget() const { return budget; }
+
+	uint32_t getExpansions() const { return expansions; }
+private:
+	// Search state of a cell, only meaningful when stamp matches the current search
+	struct node
+	{
+		uint32_t g;
+		uint32_t parent;
+		uint32_t stamp;
+		bool closed;
+	};
+
+	// Open list entry: <f, <g, cell>>
+	typedef std::pair<uint32_t, std::pair<uint32_t, uint32_t>> openEntry;
+
+	uint32_t calculateHValue(uint32_t id, const Pair& target);
+private:
+	Maze* maze;
+	uint32_t budget;
+	uint32_t expansions;
+	uint32_t stamp;
+	uint32_t drift; // Total cost the target travelled since the last reset
+	uint32_t revision;
+	std::vector<node> nodes;
+	std::vector<uint32_t> learned; // Learned h + drift at the time it was learned, 0 if unknown
+	std::vector<openEntry> openList;
+	std::vector<uint32_t> closedList;
+};
\ No newline at end of file
@@ -9,7 +9,10 @@
 #endif
 
 MazeSolver::MazeSolver(int Window_W, int Window_H, int Maze_W, int Maze_H) :
-	window(NULL), renderer(NULL), event(), maze(), currentSelection(0),
+	window(NULL), renderer(NULL), event(), maze(), tree(&maze), junctions(&maze),
+	fill4(&maze, Maze::MOVES_4), fill8(&maze, Maze::MOVES_8),
+	parts4(&maze, Maze::MOVES_4), parts8(&maze, Maze::MOVES_8), bounds(&maze),
+	swamps4(&maze, Maze::MOVES_4), swamps8(&maze, Maze::MOVES_8), ch(&maze), transit(&maze), currentSelection(0),
 	Window_H(Window_H), Window_W(Window_W), MAZE_W(Maze_W), MAZE_H(Maze_H),
 	isMouseDown(false)
 {
@@ -32,6 +35,14 @@ void MazeSolver::Init()
 	TTF_SetFontHinting(font, TTF_HINTING_MONO);
 
 	maze.Init(renderer, MAZE_H, MAZE_W);
+
+	if (!ch_file.empty() && !ch.Load(ch_file.c_str())) {
+		auto begin = std::chrono::steady_clock::now();
+		ch.Build(maze.GetThreadCount());
+		printf("Contraction hierarchy built in %.1f ms (%u shortcuts)\n",
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count(), ch.GetShortcutCount());
+		ch.Save(ch_file.c_str());
+	}
 }
 
 void MazeSolver::Loop()
@@ -86,12 +97,12 @@ void MazeSolver::Loop()
 
 		if (r == DISJKSTRA) {
 			printf("Starting Dijsktra Algorithm:\n");
-			Dijsktra dijsktra(&maze);
+			Dijsktra dijsktra(&maze, &tree, &junctions, &fill4, &parts4, &ch, &swamps4, use_transit ? &transit : NULL);
 			dijsktra.Start(maze.getStart(), maze.getEnd());
 			std::this_thread::sleep_for(std::chrono::seconds(3));
 		} else if (r == A_STAR_EUC || r == A_STAR_MAN) {
 			printf("Starting A* Algorithm:\n");
-			AStar astar(&maze);
+			AStar astar(&maze, &fill8, &parts8, &bounds, &swamps8);
 			astar.AStarSearch((AStar::distance_t)(r - 1), maze.getStart(), maze.getEnd());
 			std::this_thread::sleep_for(std::chrono::seconds(3));
 		} else if (r == CAT_MOUSE) {
@@ -4,6 +4,14 @@
 #include <SDL_ttf.h>
 #include "Text.hpp"
 #include "maze.hpp"
+#include "TreeIndex.hpp"
+#include "JunctionGraph.hpp"
+#include "DeadEndFilter.hpp"
+#include "Components.hpp"
+#include "ContractionHierarchy.hpp"
+#include "GoalBounds.hpp"
+#include "Swamps.hpp"
+#include "TransitNodes.hpp"
 
 class MazeSolver
 {
@@ -27,6 +35,14 @@ public:
 	void Clean();
 
 	void TextRendering();
+
+	Maze& getMaze() { return maze; }
+
+	// File of the contraction hierarchy, loaded at start or built and saved there
+	void setIndexFile(const std::string& file) { ch_file = file; }
+
+	// Dijkstra answers from the transit node tables
+	void setTransitNodes(bool enabled) { use_transit = enabled; }
 private:
 	constexpr static int MAX_MENU = 13;
 
@@ -40,6 +56,19 @@ private:
 	Text* current_cell;
 	SDL_Event event;
 	Maze maze;
+	TreeIndex tree; // Shortest paths while the maze stays perfect
+	JunctionGraph junctions; // Contracted corridors, for the other mazes
+	DeadEndFilter fill4; // Dead ends for Dijkstra
+	DeadEndFilter fill8; // Dead ends for A*
+	Components parts4; // Connected parts for Dijkstra
+	Components parts8; // Connected parts for A*
+	GoalBounds bounds; // Goal bounding boxes for A*
+	Swamps swamps4; // Regions behind a gate for Dijkstra
+	Swamps swamps8; // Regions behind a gate for A*
+	ContractionHierarchy ch; // Preprocessed Dijkstra, only with an index file
+	std::string ch_file;
+	TransitNodes transit; // Block tables for Dijkstra, only when enabled
+	bool use_transit = false;
 	int currentSelection = 0;
 	int Window_H = 768;
 	int Window_W = 768;
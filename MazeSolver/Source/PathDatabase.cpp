@@ -0,0 +1,172 @@
+#include "PathDatabase.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <functional>
+#include <cstdio>
+
+constexpr uint32_t PathDatabase::MAX_CELLS;
+constexpr uint8_t PathDatabase::NONE;
+
+// Moves of the agents, same as A*
+static constexpr int DIR_ROW[] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+static constexpr int DIR_COL[] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+
+typedef std::pair<uint32_t, uint32_t> entry_t; // <distance, cell>
+
+PathDatabase::PathDatabase(Maze* maze) : maze(maze), revision(0), built(false)
+{
+}
+
+uint32_t PathDatabase::Index(const Pair& cell) const
+{
+	if (!maze->isValid(cell))
+		return UINT32_MAX;
+
+	return index[cell.first * maze->GetCols() + cell.second];
+}
+
+bool PathDatabase::Build(uint32_t threads)
+{
+	int ROW = maze->GetRows();
+	int COL = maze->GetCols();
+
+	built = false;
+	cells.clear();
+	index.assign(ROW * COL, UINT32_MAX);
+
+	for (int i = 0; i < ROW; i++) {
+		for (int j = 0; j < COL; j++) {
+			if (maze->isUnBlocked(i, j)) {
+				index[i * COL + j] = (uint32_t)cells.size();
+				cells.push_back(Pair(i, j));
+			}
+		}
+	}
+
+	uint32_t n = (uint32_t)cells.size();
+
+	if (n > MAX_CELLS) {
+		printf("The maze has %u open cells, the path database handles up to %u\n", n, MAX_CELLS);
+		return false;
+	}
+
+	// Neighbours and the move leading to them, in compressed rows
+	std::vector<uint32_t> start(1, 0), next, cost;
+	std::vector<uint8_t> move;
+
+	for (const Pair& cell : cells) {
+		for (uint8_t d = 0; d < 8; d++) {
+			Pair to(cell.first + DIR_ROW[d], cell.second + DIR_COL[d]);
+			uint32_t v = this->Index(to);
+
+			if (v != UINT32_MAX) {
+				next.push_back(v);
+				cost.push_back(maze->getCellCost(to.first, to.second));
+				move.push_back(d);
+			}
+		}
+
+		start.push_back((uint32_t)next.size());
+	}
+
+	ThreadPool pool(threads);
+	uint32_t T = pool.GetThreadCount();
+	std::vector<std::vector<uint32_t>> dist(T), first(T);
+	std::vector<std::vector<entry_t>> openList(T);
+	std::vector<std::vector<uint32_t>> rows(n);
+
+	pool.ParallelFor(n, [&](uint32_t begin, uint32_t end, uint32_t thread) {
+		std::vector<uint32_t>& d = dist[thread];
+		std::vector<uint32_t>& f = first[thread];
+		std::vector<entry_t>& q = openList[thread];
+
+		for (uint32_t s = begin; s < end; s++) {
+			d.assign(n, UINT32_MAX);
+			f.assign(n, NONE);
+			q.clear();
+
+			d[s] = 0;
+			q.push_back(entry_t(0, s));
+
+			// Every cell inherits the first move of its parent
+			while (!q.empty()) {
+				std::pop_heap(q.begin(), q.end(), std::greater<entry_t>());
+				entry_t e = q.back();
+				q.pop_back();
+
+				if (e.first != d[e.second])
+					continue;
+
+				for (uint32_t k = start[e.second]; k < start[e.second + 1]; k++) {
+					uint32_t v = next[k];
+
+					if (e.first + cost[k] < d[v]) {
+						d[v] = e.first + cost[k];
+						f[v] = (e.second == s) ? move[k] : f[e.second];
+						q.push_back(entry_t(d[v], v));
+						std::push_heap(q.begin(), q.end(), std::greater<entry_t>());
+					}
+				}
+			}
+
+			// The source itself can take any move, it extends the run before it
+			std::vector<uint32_t>& row = rows[s];
+
+			for (uint32_t t = 0; t < n; t++) {
+				if (t == s)
+					continue;
+
+				if (row.empty())
+					row.push_back(f[t]); // The first run starts at 0
+				else if ((row.back() & 0xf) != f[t])
+					row.push_back(t << 4 | f[t]);
+			}
+
+			if (row.empty())
+				row.push_back(NONE);
+
+			row.shrink_to_fit();
+		}
+	}, 16);
+
+	runStart.assign(1, 0);
+	runs.clear();
+
+	for (uint32_t s = 0; s < n; s++) {
+		runs.insert(runs.end(), rows[s].begin(), rows[s].end());
+		runStart.push_back((uint32_t)runs.size());
+	}
+
+	revision = maze->GetRevision();
+	built = true;
+	return true;
+}
+
+uint8_t PathDatabase::FirstMove(const Pair& s, const Pair& t) const
+{
+	if (!built)
+		return NONE;
+
+	uint32_t u = this->Index(s);
+	uint32_t v = this->Index(t);
+
+	if (u == UINT32_MAX || v == UINT32_MAX || u == v)
+		return NONE;
+
+	// Last run starting at v or before
+	const uint32_t* begin = runs.data() + runStart[u];
+	const uint32_t* end = runs.data() + runStart[u + 1];
+	const uint32_t* run = std::upper_bound(begin, end, v << 4 | 0xf);
+
+	return *(run - 1) & 0xf;
+}
+
+Pair PathDatabase::GetNext(const Pair& s, const Pair& t) const
+{
+	uint8_t d = this->FirstMove(s, t);
+
+	if (d == NONE)
+		return s;
+
+	return Pair(s.first + DIR_ROW[d], s.second + DIR_COL[d]);
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "maze.hpp"
+#include <vector>
+
+class Maze;
+
+// Compressed path database: for every source, the first move (same 8 moves as A*) of a
+// cheapest path toward every target. The targets are taken in row order, so whole areas of
+// the maze share a first move and a row is stored as runs <first target, move>. The rows
+// are filled by one Dijkstra per source, in parallel. A query is a binary search in the
+// runs of its source, no search of the maze.
+class PathDatabase
+{
+public:
+	static constexpr uint32_t MAX_CELLS = 16384;
+	static constexpr uint8_t NONE = 0xf;
+
+	PathDatabase(Maze* maze);
+
+	// Returns false if the maze has too many open cells
+	bool Build(uint32_t threads = 0);
+
+	bool IsValid() const { return built && revision == maze->GetRevision(); }
+
+	// Direction of the first move from s toward t, NONE if t can't be reached (or is s)
+	uint8_t FirstMove(const Pair& s, const Pair& t) const;
+
+	// Next cell from s toward t (s itself if there is none)
+	Pair GetNext(const Pair& s, const Pair& t) const;
+
+	uint32_t getCellCount() const { return (uint32_t)cells.size(); }
+
+	uint32_t getRunCount() const { return (uint32_t)runs.size(); }
+private:
+	uint32_t Index(const Pair& cell) const;
+private:
+	Maze* maze;
+	uint32_t revision;
+	bool built;
+	std::vector<uint32_t> index; // Maze cell -> open cell index (UINT32_MAX for walls)
+	std::vector<Pair> cells;
+	std::vector<uint32_t> runStart; // Runs of every source
+	std::vector<uint32_t> runs; // First target << 4 | move
+};
\ No newline at end of file
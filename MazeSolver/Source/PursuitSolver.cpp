@@ -0,0 +1,321 @@
+#include "PursuitSolver.hpp"
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <climits>
+
+constexpr uint32_t PursuitSolver::MAX_CELLS;
+constexpr uint16_t PursuitSolver::DRAW;
+
+// Field of 'width' bits of the state s, it may straddle two words
+static uint64_t GetField(const std::vector<std::atomic<uint64_t>>& table, uint64_t s, uint32_t width)
+{
+	uint64_t bit = s * width;
+	uint32_t shift = (uint32_t)(bit & 63);
+	uint64_t value = table[bit >> 6].load(std::memory_order_relaxed) >> shift;
+
+	if (shift + width > 64)
+		value |= table[(bit >> 6) + 1].load(std::memory_order_relaxed) << (64 - shift);
+
+	return value & ((1ull << width) - 1);
+}
+
+// Set a field still 0, the fields sharing a word may be set by other threads
+static void SetField(std::vector<std::atomic<uint64_t>>& table, uint64_t s, uint32_t width, uint64_t value)
+{
+	uint64_t bit = s * width;
+	uint32_t shift = (uint32_t)(bit & 63);
+
+	table[bit >> 6].fetch_or(value << shift, std::memory_order_relaxed);
+
+	if (shift + width > 64)
+		table[(bit >> 6) + 1].fetch_or(value >> (64 - shift), std::memory_order_relaxed);
+}
+
+PursuitSolver::PursuitSolver(Maze* maze) : maze(maze), n(0), revision(0), built(false), width(0)
+{
+}
+
+uint16_t PursuitSolver::Depth(uint32_t cat, uint32_t mouse, side_t side) const
+{
+	uint64_t value = GetField(depth[side], (uint64_t)cat * n + mouse, width);
+	return value == 0 ? DRAW : (uint16_t)(value - 1);
+}
+
+void PursuitSolver::Widen(uint32_t bits, ThreadPool& pool)
+{
+	// 64 states take 'width' words before and 'bits' words after, a thread writes whole words
+	uint64_t blocks = ((uint64_t)n * n + 63) / 64;
+
+	for (uint32_t side = 0; side < 2; side++) {
+		std::vector<std::atomic<uint64_t>> wider(blocks * bits + 1);
+
+		pool.ParallelFor((uint32_t)blocks, [this, &wider, side, bits](uint32_t begin, uint32_t end, uint32_t) {
+			for (uint64_t b = begin; b < end; b++) {
+				uint64_t words[16] = {};
+				uint64_t any = 0;
+
+				for (uint32_t w = 0; w < width; w++)
+					any |= depth[side][b * width + w].load(std::memory_order_relaxed);
+
+				for (uint32_t k = 0; k < 64 && any; k++) {
+					uint64_t value = GetField(depth[side], b * 64 + k, width);
+					uint32_t bit = k * bits;
+
+					words[bit >> 6] |= value << (bit & 63);
+
+					if ((bit & 63) + bits > 64)
+						words[(bit >> 6) + 1] |= value >> (64 - (bit & 63));
+				}
+
+				for (uint32_t w = 0; w < bits; w++)
+					wider[b * bits + w].store(words[w], std::memory_order_relaxed);
+			}
+		});
+
+		depth[side].swap(wider);
+	}
+
+	width = bits;
+}
+
+uint32_t PursuitSolver::Index(const Pair& cell) const
+{
+	if (!maze->isValid(cell))
+		return UINT32_MAX;
+
+	return index[cell.first * maze->GetCols() + cell.second];
+}
+
+bool PursuitSolver::Build(uint32_t threads)
+{
+	int ROW = maze->GetRows();
+	int COL = maze->GetCols();
+
+	built = false;
+	cells.clear();
+	index.assign(ROW * COL, UINT32_MAX);
+
+	for (int i = 0; i < ROW; i++) {
+		for (int j = 0; j < COL; j++) {
+			if (maze->isUnBlocked(i, j)) {
+				index[i * COL + j] = (uint32_t)cells.size();
+				cells.push_back(Pair(i, j));
+			}
+		}
+	}
+
+	n = (uint32_t)cells.size();
+
+	if (n > MAX_CELLS) {
+		printf("The maze has %u open cells, the pursuit solver handles up to %u\n", n, MAX_CELLS);
+		return false;
+	}
+
+	// Moves of both agents, staying in place first
+	constexpr Pair catMoves[] = {
+		Pair(0, 0),
+		Pair(-1, -1), Pair(-1, 0), Pair(-1, 1),
+		Pair(0, -1)              , Pair(0, 1),
+		Pair(1, -1), Pair(1, 0)  , Pair(1, 1),
+	};
+
+	constexpr Pair mouseMoves[] = {
+		             Pair(0, 0) ,
+		             Pair(-1, 0),
+		Pair(0, -1)             , Pair(0, 1),
+		             Pair(1, 0) ,
+	};
+
+	catStart.assign(1, 0);
+	mouseStart.assign(1, 0);
+	catNext.clear();
+	mouseNext.clear();
+
+	for (const Pair& cell : cells) {
+		for (const Pair& dir : catMoves) {
+			uint32_t v = this->Index(cell + dir);
+
+			if (v != UINT32_MAX)
+				catNext.push_back(v);
+		}
+
+		for (const Pair& dir : mouseMoves) {
+			uint32_t v = this->Index(cell + dir);
+
+			if (v != UINT32_MAX)
+				mouseNext.push_back(v);
+		}
+
+		catStart.push_back((uint32_t)catNext.size());
+		mouseStart.push_back((uint32_t)mouseNext.size());
+	}
+
+	uint64_t states = (uint64_t)n * n;
+	std::vector<std::atomic<uint64_t>> won[2]; // One bit per state, set once the cat is sure to win
+	std::vector<std::atomic<uint8_t>> left(states); // Mouse to move: moves not refuted yet
+
+	won[CAT_TO_MOVE] = std::vector<std::atomic<uint64_t>>((states + 63) / 64);
+	won[MOUSE_TO_MOVE] = std::vector<std::atomic<uint64_t>>((states + 63) / 64);
+	// One bit per state to begin with, enough for the captures
+	width = 1;
+	depth[CAT_TO_MOVE] = std::vector<std::atomic<uint64_t>>((states + 63) / 64 + 1);
+	depth[MOUSE_TO_MOVE] = std::vector<std::atomic<uint64_t>>((states + 63) / 64 + 1);
+
+	ThreadPool pool(threads);
+
+	pool.ParallelFor(n, [this, &left](uint32_t begin, uint32_t end, uint32_t) {
+		for (uint32_t c = begin; c < end; c++) {
+			for (uint32_t m = 0; m < n; m++) {
+				left[(uint64_t)c * n + m].store((uint8_t)(mouseStart[m + 1] - mouseStart[m]), std::memory_order_relaxed);
+			}
+		}
+	});
+
+	// The captures are won in 0 plies, whoever has to move; a state is <side, cat * n + mouse>
+	std::vector<uint64_t> frontier;
+
+	for (uint32_t c = 0; c < n; c++) {
+		uint64_t s = (uint64_t)c * n + c;
+
+		for (uint32_t side = 0; side < 2; side++) {
+			won[side][s >> 6] |= 1ull << (s & 63);
+			SetField(depth[side], s, width, 1);
+			frontier.push_back(((uint64_t)side << 63) | s);
+		}
+	}
+
+	std::vector<std::vector<uint64_t>> next(pool.GetThreadCount());
+
+	// Backward induction, one ply per round. Each state is claimed by the thread setting its bit,
+	// which alone writes its depth, so the tables don't depend on the scheduling.
+	for (uint16_t level = 0; !frontier.empty() && level < DRAW - 1; level++) {
+		// This round writes level + 2
+		if (level + 2u >= 1u << width)
+			this->Widen(width + 1, pool);
+
+		pool.ParallelFor((uint32_t)frontier.size(), [this, &frontier, &next, &won, &left, level](uint32_t begin, uint32_t end, uint32_t thread) {
+			for (uint32_t k = begin; k < end; k++) {
+				side_t side = (side_t)(frontier[k] >> 63);
+				uint64_t s = frontier[k] & ~(1ull << 63);
+				uint32_t c = (uint32_t)(s / n);
+				uint32_t m = (uint32_t)(s % n);
+
+				if (side == MOUSE_TO_MOVE) {
+					// The cat had a move to this state: every cat to move predecessor is won
+					for (uint32_t e = catStart[c]; e < catStart[c + 1]; e++) {
+						uint64_t p = (uint64_t)catNext[e] * n + m;
+						uint64_t bit = 1ull << (p & 63);
+
+						if (won[CAT_TO_MOVE][p >> 6].load(std::memory_order_relaxed) & bit)
+							continue;
+
+						if (!(won[CAT_TO_MOVE][p >> 6].fetch_or(bit) & bit)) {
+							SetField(depth[CAT_TO_MOVE], p, width, level + 2);
+							next[thread].push_back(p);
+						}
+					}
+				} else {
+					// One more mouse move refuted, the predecessor is won once they all are
+					for (uint32_t e = mouseStart[m]; e < mouseStart[m + 1]; e++) {
+						uint64_t p = (uint64_t)c * n + mouseNext[e];
+						uint64_t bit = 1ull << (p & 63);
+
+						if (won[MOUSE_TO_MOVE][p >> 6].load(std::memory_order_relaxed) & bit)
+							continue;
+
+						if (left[p].fetch_sub(1) == 1 && !(won[MOUSE_TO_MOVE][p >> 6].fetch_or(bit) & bit)) {
+							SetField(depth[MOUSE_TO_MOVE], p, width, level + 2);
+							next[thread].push_back((1ull << 63) | p);
+						}
+					}
+				}
+			}
+		}, 256);
+
+		frontier.clear();
+
+		for (std::vector<uint64_t>& part : next) {
+			frontier.insert(frontier.end(), part.begin(), part.end());
+			part.clear();
+		}
+	}
+
+	revision = maze->GetRevision();
+	built = true;
+	return true;
+}
+
+bool PursuitSolver::CatWins(const Pair& cat, const Pair& mouse, bool catToMove) const
+{
+	return this->MovesToCapture(cat, mouse, catToMove) != UINT32_MAX;
+}
+
+uint32_t PursuitSolver::MovesToCapture(const Pair& cat, const Pair& mouse, bool catToMove) const
+{
+	uint32_t c = this->Index(cat);
+	uint32_t m = this->Index(mouse);
+
+	if (!built || c == UINT32_MAX || m == UINT32_MAX)
+		return UINT32_MAX;
+
+	uint16_t d = this->Depth(c, m, catToMove ? CAT_TO_MOVE : MOUSE_TO_MOVE);
+	return d == DRAW ? UINT32_MAX : d;
+}
+
+// Quickest win, or the cell closest to the mouse when it can escape
+Pair PursuitSolver::BestCatMove(const Pair& cat, const Pair& mouse) const
+{
+	uint32_t c = this->Index(cat);
+	uint32_t m = this->Index(mouse);
+
+	if (!built || c == UINT32_MAX || m == UINT32_MAX)
+		return cat;
+
+	uint32_t best = c;
+	uint32_t best_d = UINT32_MAX;
+	int best_h = INT_MAX;
+
+	for (uint32_t e = catStart[c]; e < catStart[c + 1]; e++) {
+		uint32_t v = catNext[e];
+		uint32_t d = this->Depth(v, m, MOUSE_TO_MOVE);
+		int h = std::max(std::abs(cells[v].first - mouse.first), std::abs(cells[v].second - mouse.second));
+
+		if (d < best_d || (d == best_d && h < best_h)) {
+			best = v;
+			best_d = d;
+			best_h = h;
+		}
+	}
+
+	return cells[best];
+}
+
+// Any escaping move (the farthest from the cat), otherwise the slowest defeat
+Pair PursuitSolver::BestMouseMove(const Pair& cat, const Pair& mouse) const
+{
+	uint32_t c = this->Index(cat);
+	uint32_t m = this->Index(mouse);
+
+	if (!built || c == UINT32_MAX || m == UINT32_MAX)
+		return mouse;
+
+	uint32_t best = m;
+	int best_d = -1;
+	int best_h = -1;
+
+	for (uint32_t e = mouseStart[m]; e < mouseStart[m + 1]; e++) {
+		uint32_t v = mouseNext[e];
+		int d = this->Depth(c, v, CAT_TO_MOVE);
+		int h = std::max(std::abs(cells[v].first - cat.first), std::abs(cells[v].second - cat.second));
+
+		if (d > best_d || (d == best_d && h > best_h)) {
+			best = v;
+			best_d = d;
+			best_h = h;
+		}
+	}
+
+	return cells[best];
+}
\ No newline at end of file
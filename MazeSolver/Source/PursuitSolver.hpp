@@ -0,0 +1,65 @@
+#pragma once
+
+#include "maze.hpp"
+#include "ThreadPool.hpp"
+#include <atomic>
+#include <vector>
+
+class Maze;
+
+// Retrograde analysis of the Cat & Mouse game on the current maze.
+// A state is (cat cell, mouse cell, side to move): the cat moves like A* (8 directions),
+// the mouse on the 4 directions, both may stay in place, the cat wins by reaching the mouse.
+// The states are solved backward from the captures, one level (ply) at a time in parallel,
+// with bit-packed "won" tables and 8-bit counters of the mouse moves not refuted yet.
+// The depths are packed too, on as many bits as the deepest level needs (widened while solving).
+// Afterwards the best move of both agents is found in O(1).
+class PursuitSolver
+{
+public:
+	static constexpr uint32_t MAX_CELLS = 4096;
+	static constexpr uint16_t DRAW = UINT16_MAX;
+
+	PursuitSolver(Maze* maze);
+
+	// Solve every state of the maze, returns false if it has too many open cells
+	bool Build(uint32_t threads = 0);
+
+	bool IsValid() const { return built && revision == maze->GetRevision(); }
+
+	bool CatWins(const Pair& cat, const Pair& mouse, bool catToMove) const;
+
+	// Plies left before the capture with both sides playing their best, UINT32_MAX if the mouse escapes forever
+	uint32_t MovesToCapture(const Pair& cat, const Pair& mouse, bool catToMove) const;
+
+	Pair BestCatMove(const Pair& cat, const Pair& mouse) const;
+
+	Pair BestMouseMove(const Pair& cat, const Pair& mouse) const;
+
+	uint32_t getCellCount() const { return n; }
+private:
+	enum side_t {
+		CAT_TO_MOVE = 0,
+		MOUSE_TO_MOVE = 1,
+	};
+
+	uint16_t Depth(uint32_t cat, uint32_t mouse, side_t side) const;
+
+	// Copy the depths to fields of 'bits' bits
+	void Widen(uint32_t bits, ThreadPool& pool);
+
+	uint32_t Index(const Pair& cell) const;
+private:
+	Maze* maze;
+	uint32_t n; // Number of open cells
+	uint32_t revision;
+	bool built;
+	std::vector<uint32_t> index; // Maze cell -> open cell index (UINT32_MAX for walls)
+	std::vector<Pair> cells;
+	// Neighbours (staying in place included) in compressed rows
+	std::vector<uint32_t> catStart, catNext;
+	std::vector<uint32_t> mouseStart, mouseNext;
+	// Plies + 1 of the won states on 'width' bits each, 0 for DRAW
+	uint32_t width;
+	std::vector<std::atomic<uint64_t>> depth[2];
+};
\ No newline at end of file
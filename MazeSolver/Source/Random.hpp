@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+
+// xoshiro256** pseudo random numbers, seeded through SplitMix64. The same seed always gives
+// the same numbers, so a maze (and what runs on it) can be made again.
+class Random
+{
+public:
+	explicit Random(uint64_t seed = 0)
+	{
+		this->Seed(seed);
+	}
+
+	void Seed(uint64_t seed)
+	{
+		for (int i = 0; i < 4; i++) {
+			seed += 0x9e3779b97f4a7c15ull;
+			uint64_t z = seed;
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+			state[i] = z ^ (z >> 31);
+		}
+	}
+
+	uint64_t Next()
+	{
+		uint64_t result = Rotate(state[1] * 5, 7) * 9;
+		uint64_t t = state[1] << 17;
+
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= t;
+		state[3] = Rotate(state[3], 45);
+
+		return result;
+	}
+
+	// Number in [0, n), from the high bits (multiply and shift, no division)
+	uint32_t operator()(uint32_t n)
+	{
+		return (uint32_t)(((this->Next() >> 32) * n) >> 32);
+	}
+private:
+	static uint64_t Rotate(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+private:
+	uint64_t state[4];
+};
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include "Simulation.hpp"
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+
+Simulation::Simulation(Maze* maze, uint32_t threads) :
+	maze(maze), pool(threads), seed(0), caught(0), ticks(0), budget(64)
+{
+}
+
+// SplitMix64 finalizer, turns a key into a well mixed pseudo random number
+uint64_t Simulation::Mix(uint64_t x)
+{
+	x += 0x9e3779b97f4a7c15ull;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+	return x ^ (x >> 31);
+}
+
+// Free cell picked from a key, the same key always gives the same cell
+Pair Simulation::RandomCell(uint64_t key)
+{
+	for (uint32_t k = 0; k < 1000; k++) {
+		uint64_t r = Mix(key * 1000 + k);
+		Pair cell((int)(r % maze->GetRows()), (int)((r >> 32) % maze->GetCols()));
+
+		if (maze->isUnBlocked(cell))
+			return cell;
+	}
+
+	return Pair(1, 1);
+}
+
+void Simulation::Spawn(uint32_t catCount, uint32_t miceCount, uint64_t seed)
+{
+	this->seed = seed;
+	caught = 0;
+	ticks = 0;
+	cats.clear();
+	mice.clear();
+
+	for (uint32_t i = 0; i < catCount; i++) {
+		cats.push_back(RandomCell(Mix(seed) + i));
+	}
+
+	for (uint32_t i = 0; i < miceCount; i++) {
+		mice.push_back(RandomCell(Mix(seed + 1) + i));
+	}
+
+	moves.resize(cats.size() + mice.size());
+
+	// One search workspace per thread
+	node n = { UINT32_MAX, 0, 0, false };
+	workspaces.resize(pool.GetThreadCount());
+
+	for (workspace& ws : workspaces) {
+		ws.nodes.assign(maze->GetRows() * maze->GetCols(), n);
+		ws.stamp = 0;
+	}
+}
+
+Pair Simulation::PlanCat(uint32_t id, workspace& ws)
+{
+	int COL = maze->GetCols();
+	Pair cat = cats[id];
+	Pair target = cat;
+	int best_d = INT_MAX;
+
+	constexpr Pair coords[] = {
+		Pair(-1, -1), Pair(-1, 0), Pair(-1, 1),
+		Pair(0, -1)              , Pair(0, 1),
+		Pair(1, -1), Pair(1, 0)  , Pair(1, 1),
+	};
+
+	// Chase the nearest mouse
+	for (const Pair& mouse : mice) {
+		int d = std::max(std::abs(mouse.first - cat.first), std::abs(mouse.second - cat.second));
+
+		if (d < best_d) {
+			best_d = d;
+			target = mouse;
+		}
+	}
+
+	if (target == cat)
+		return cat;
+
+	// A* bounded by the budget, ends on the target or on the best cell of the frontier
+	if (++ws.stamp == 0) {
+		for (node& n : ws.nodes)
+			n.stamp = 0;
+
+		ws.stamp = 1;
+	}
+
+	uint32_t src = cat.first * COL + cat.second;
+	uint32_t dest = target.first * COL + target.second;
+	uint32_t best = UINT32_MAX;
+	uint32_t expansions = 0;
+
+	ws.openList.clear();
+	ws.nodes[src].g = 0;
+	ws.nodes[src].parent = src;
+	ws.nodes[src].stamp = ws.stamp;
+	ws.nodes[src].closed = false;
+	ws.openList.push_back(std::make_pair((uint32_t)best_d, std::make_pair(0u, src)));
+
+	while (!ws.openList.empty()) {
+		std::pop_heap(ws.openList.begin(), ws.openList.end(), std::greater<std::pair<uint32_t, std::pair<uint32_t, uint32_t>>>());
+		uint32_t v = ws.openList.back().second.second;
+		uint32_t g = ws.openList.back().second.first;
+		ws.openList.pop_back();
+
+		node& n = ws.nodes[v];
+
+		if (n.closed || n.g != g)
+			continue;
+
+		if (v == dest || expansions == budget) {
+			best = v;
+			break;
+		}
+
+		n.closed = true;
+		expansions++;
+
+		int i = v / COL;
+		int j = v % COL;
+
+		for (const Pair& dir : coords) {
+			int ni = i + dir.first;
+			int nj = j + dir.second;
+
+			if (!maze->isValid(ni, nj) || !maze->isUnBlocked(ni, nj))
+				continue;
+
+			uint32_t nid = ni * COL + nj;
+			node& m = ws.nodes[nid];
+			uint32_t newG = n.g + maze->getCellCost(ni, nj);
+
+			if (m.stamp != ws.stamp) {
+				m.stamp = ws.stamp;
+				m.g = UINT32_MAX;
+				m.closed = false;
+			}
+
+			if (!m.closed && newG < m.g) {
+				uint32_t h = (uint32_t)std::max(std::abs(ni - target.first), std::abs(nj - target.second)) * Maze::getMinCost();
+				m.g = newG;
+				m.parent = v;
+				ws.openList.push_back(std::make_pair(newG + h, std::make_pair(newG, nid)));
+				std::push_heap(ws.openList.begin(), ws.openList.end(), std::greater<std::pair<uint32_t, std::pair<uint32_t, uint32_t>>>());
+			}
+		}
+	}
+
+	if (best == UINT32_MAX) // The mouse can't be reached
+		return cat;
+
+	while (ws.nodes[best].parent != src)
+		best = ws.nodes[best].parent;
+
+	return Pair(best / COL, best % COL);
+}
+
+Pair Simulation::PlanMouse(uint32_t id)
+{
+	Pair mouse = mice[id];
+	Pair cat = mouse;
+	int best_d = INT_MAX;
+
+	constexpr Pair coords[] = {
+		             Pair(0, 0) ,
+		             Pair(-1, 0),
+		Pair(0, -1)             , Pair(0, 1),
+		             Pair(1, 0) ,
+	};
+
+	// Run away from the nearest cat
+	for (const Pair& c : cats) {
+		int d = std::max(std::abs(mouse.first - c.first), std::abs(mouse.second - c.second));
+
+		if (d < best_d) {
+			best_d = d;
+			cat = c;
+		}
+	}
+
+	Pair next = mouse;
+	int best_score = -1;
+	uint64_t best_rnd = 0;
+
+	// Ties are broken by a number drawn from (seed, mouse, tick, move), so every run is the same
+	for (uint32_t k = 0; k < 5; k++) {
+		Pair cell = mouse + coords[k];
+
+		if (!maze->isValid(cell) || !maze->isUnBlocked(cell))
+			continue;
+
+		int score = cats.empty() ? 0 : std::max(std::abs(cell.first - cat.first), std::abs(cell.second - cat.second));
+		uint64_t rnd = Mix(seed ^ Mix(((uint64_t)ticks << 32) ^ ((uint64_t)id << 3) ^ k));
+
+		if (score > best_score || (score == best_score && rnd > best_rnd)) {
+			best_score = score;
+			best_rnd = rnd;
+			next = cell;
+		}
+	}
+
+	return next;
+}
+
+void Simulation::Tick()
+{
+	uint32_t catCount = (uint32_t)cats.size();
+
+	// Planning: every agent reads the same snapshot and writes its own slot
+	pool.ParallelFor((uint32_t)moves.size(), [this, catCount](uint32_t begin, uint32_t end, uint32_t thread) {
+		for (uint32_t i = begin; i < end; i++) {
+			moves[i] = (i < catCount) ? this->PlanCat(i, workspaces[thread]) : this->PlanMouse(i - catCount);
+		}
+	}, 64);
+
+	// Apply the moves in agent order
+	std::vector<std::pair<Pair, Pair>> catMoves; // <new cell, old cell>
+
+	for (uint32_t i = 0; i < catCount; i++) {
+		catMoves.push_back(std::make_pair(moves[i], cats[i]));
+		cats[i] = moves[i];
+	}
+
+	std::sort(catMoves.begin(), catMoves.end());
+
+	for (uint32_t i = 0; i < mice.size(); i++) {
+		Pair from = mice[i];
+		mice[i] = moves[catCount + i];
+
+		// Caught when a cat stands on the mouse or they crossed each other
+		std::vector<std::pair<Pair, Pair>>::iterator it = std::lower_bound(catMoves.begin(), catMoves.end(), std::make_pair(mice[i], Pair(INT_MIN, INT_MIN)));
+		bool isCaught = (it != catMoves.end() && it->first == mice[i])
+			|| std::binary_search(catMoves.begin(), catMoves.end(), std::make_pair(from, mice[i]));
+
+		if (isCaught) {
+			mice[i] = RandomCell(Mix(seed + 2 + ticks) + i);
+			caught++;
+		}
+	}
+
+	ticks++;
+}
\ No newline at end of file
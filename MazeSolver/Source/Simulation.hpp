@@ -0,0 +1,72 @@
+#pragma once
+
+#include "maze.hpp"
+#include "ThreadPool.hpp"
+#include <vector>
+
+class Maze;
+
+// Cat & Mouse with many agents and no rendering.
+// Every tick all the agents plan in parallel from the same snapshot of the positions
+// (each thread with its own search workspace), then the moves are applied in agent
+// order, so the result does not depend on the number of threads.
+// Cats chase the nearest mouse with a bounded A* (same moves as A*), mice run away
+// from the nearest cat on the 4 directions, caught mice respawn on a random cell.
+class Simulation
+{
+public:
+	Simulation(Maze* maze, uint32_t threads = 0);
+
+	void Spawn(uint32_t cats, uint32_t mice, uint64_t seed = 0);
+
+	void Tick();
+
+	const std::vector<Pair>& GetCats() const { return cats; }
+
+	const std::vector<Pair>& GetMice() const { return mice; }
+
+	uint64_t getCaught() const { return caught; }
+
+	uint32_t getTicks() const { return ticks; }
+
+	uint32_t GetThreadCount() const { return pool.GetThreadCount(); }
+
+	// Maximum number of cells a cat expands per tick
+	void setBudget(uint32_t budget) { this->budget = budget > 0 ? budget : 1; }
+private:
+	// Search state of a cell, only meaningful when stamp matches the current search
+	struct node
+	{
+		uint32_t g;
+		uint32_t parent;
+		uint32_t stamp;
+		bool closed;
+	};
+
+	// Per thread scratch space, reused between the searches
+	struct workspace
+	{
+		std::vector<node> nodes;
+		std::vector<std::pair<uint32_t, std::pair<uint32_t, uint32_t>>> openList; // <f, <g, cell>>
+		uint32_t stamp;
+	};
+
+	Pair PlanCat(uint32_t id, workspace& ws);
+
+	Pair PlanMouse(uint32_t id);
+
+	Pair RandomCell(uint64_t key);
+
+	static uint64_t Mix(uint64_t x);
+private:
+	Maze* maze;
+	ThreadPool pool;
+	std::vector<workspace> workspaces;
+	std::vector<Pair> cats;
+	std::vector<Pair> mice;
+	std::vector<Pair> moves; // Planned cells: the cats first then the mice
+	uint64_t seed;
+	uint64_t caught;
+	uint32_t ticks;
+	uint32_t budget;
+};
\ No newline at end of file
@@ -0,0 +1,636 @@
+#include "SubgoalGraph.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static inline uint32_t LowestBit(uint64_t x)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, x);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctzll(x);
+#endif
+}
+
+static constexpr uint32_t NONE = UINT32_MAX;
+
+// Moves of A*
+static constexpr int DIR_ROW[] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+static constexpr int DIR_COL[] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+
+static constexpr int STRAIGHT_ROW[] = { -1, 0, 0, 1 };
+static constexpr int STRAIGHT_COL[] = { 0, -1, 1, 0 };
+
+typedef std::pair<uint32_t, uint32_t> entry_t; // <f, subgoal>
+
+SubgoalGraph::SubgoalGraph(Maze* maze) : maze(maze), revision(0), built(false), rows(0), cols(0), rowWords(0), colWords(0), expanded(0), current(0)
+{
+	search.current = 0;
+}
+
+uint32_t SubgoalGraph::Distance(uint32_t a, uint32_t b) const
+{
+	return (uint32_t)std::max(std::abs((int)(a / cols) - (int)(b / cols)), std::abs((int)(a % cols) - (int)(b % cols)));
+}
+
+uint32_t SubgoalGraph::Hop(uint32_t a, uint32_t b) const
+{
+	return (this->Distance(a, b) - 1) * Maze::getMinCost() + maze->getCellCost(b / cols, b % cols);
+}
+
+bool SubgoalGraph::IsUnit(int row, int col) const
+{
+	return maze->isValid(row, col) && maze->getCellCost(row, col) == Maze::getMinCost();
+}
+
+void SubgoalGraph::Reachable(uint32_t cell, uint32_t target, rings& rs, std::vector<std::pair<uint32_t, uint32_t>>& result) const
+{
+	result.clear();
+
+	int r0 = cell / cols;
+	int c0 = cell % cols;
+	int tr = target != NONE ? (int)(target / cols) : -1;
+	int tc = target != NONE ? (int)(target % cols) : -1;
+
+	// The cells at a Chebyshev distance of 'level' form a ring, whose sides are a row (north, south)
+	// or a column (west, east) of the bitboards. The parents of the cells of a side are the cells
+	// next to them on the same side of the previous ring. A cell is covered when one of these paths
+	// crosses a subgoal: it is then reached through that subgoal as cheaply. Once a whole ring is
+	// covered nothing further can be reached directly
+	for (int side = 0; side < 4; side++) {
+		uint32_t words = side < 2 ? rowWords : colWords;
+		int center = side < 2 ? c0 : r0;
+
+		rs.reached[side].assign(words, 0);
+		rs.covered[side].assign(words, 0);
+		rs.reached[side][center >> 6] = 1ull << (center & 63);
+	}
+
+	rs.next[0].resize(std::max(rowWords, colWords));
+	rs.next[1].resize(std::max(rowWords, colWords));
+
+	for (int level = 1; ; level++) {
+		bool open = false;
+
+		for (int side = 0; side < 4; side++) {
+			int line = side == 0 ? r0 - level : side == 1 ? r0 + level : side == 2 ? c0 - level : c0 + level;
+			int previous = line + (side % 2 == 0 ? 1 : -1);
+			int center = side < 2 ? c0 : r0;
+			int length = side < 2 ? cols : rows;
+
+			if (line < 0 || line >= (side < 2 ? rows : cols))
+				continue;
+
+			uint32_t words = side < 2 ? rowWords : colWords;
+			const uint64_t* unit = side < 2 ? &unitRows[previous * words] : &unitCols[previous * words];
+			const uint64_t* sub = side < 2 ? &subgoalRows[previous * words] : &subgoalCols[previous * words];
+			const uint64_t* passable = side < 2 ? &openRows[line * words] : &openCols[line * words];
+			const uint64_t* lineUnit = side < 2 ? &unitRows[line * words] : &unitCols[line * words];
+			const uint64_t* lineSub = side < 2 ? &subgoalRows[line * words] : &subgoalCols[line * words];
+			std::vector<uint64_t>& reached = rs.reached[side];
+			std::vector<uint64_t>& covered = rs.covered[side];
+			int first = std::max(0, center - level) >> 6;
+			int last = std::min(length - 1, center + level) >> 6;
+
+			// Expanded cells of the previous ring (the cell itself whatever its cost), and those a path through a subgoal reaches
+			auto expanded = [&](int w) { return w < 0 || w >= (int)words ? 0 : level == 1 ? reached[w] : reached[w] & unit[w]; };
+			auto through = [&](int w) { return w < 0 || w >= (int)words || level == 1 ? 0 : reached[w] & unit[w] & (covered[w] | sub[w]); };
+
+			for (int w = first; w <= last; w++) {
+				uint64_t e = expanded(w), t = through(w);
+				uint64_t spreadE = e | (e << 1) | (e >> 1) | (expanded(w - 1) >> 63) | (expanded(w + 1) << 63);
+				uint64_t spreadT = t | (t << 1) | (t >> 1) | (through(w - 1) >> 63) | (through(w + 1) << 63);
+
+				rs.next[0][w] = passable[w] & spreadE;
+				rs.next[1][w] = rs.next[0][w] & spreadT;
+			}
+
+			for (int w = first; w <= last; w++) {
+				reached[w] = rs.next[0][w];
+				covered[w] = rs.next[1][w];
+
+				uint64_t uncovered = reached[w] & ~covered[w];
+				uint64_t report = uncovered & lineSub[w];
+
+				open = open || (uncovered & lineUnit[w]) != 0;
+
+				if (line == (side < 2 ? tr : tc)) {
+					int at = side < 2 ? tc : tr;
+
+					if (at >> 6 == w)
+						report |= uncovered & (1ull << (at & 63));
+				}
+
+				// The corners of the ring are on the north and south sides
+				if (side >= 2) {
+					for (int corner : { r0 - level, r0 + level }) {
+						if (corner >= 0 && corner >> 6 == w)
+							report &= ~(1ull << (corner & 63));
+					}
+				}
+
+				while (report) {
+					int bit = (int)LowestBit(report);
+					int at = w * 64 + bit;
+
+					result.push_back(std::make_pair(side < 2 ? line * cols + at : at * cols + line, (uint32_t)level));
+					report &= report - 1;
+				}
+			}
+		}
+
+		if (!open)
+			break;
+	}
+}
+
+void SubgoalGraph::Build(uint32_t threads)
+{
+	rows = maze->GetRows();
+	cols = maze->GetCols();
+	node.assign(rows * cols, NONE);
+	subgoals.clear();
+
+	for (int i = 0; i < rows; i++) {
+		for (int j = 0; j < cols; j++) {
+			if (!maze->isUnBlocked(i, j))
+				continue;
+
+			bool subgoal = maze->getCellCost(i, j) != Maze::getMinCost();
+
+			// Next to the end of a wall (or of cells costing more than the cheapest ones): the cheapest
+			// paths around it turn there. Along a wall or in a concave corner they go on as on an empty grid
+			for (int d = 0; d < 4 && !subgoal; d++) {
+				int bi = i + STRAIGHT_ROW[d];
+				int bj = j + STRAIGHT_COL[d];
+
+				if (this->IsUnit(bi, bj))
+					continue;
+
+				subgoal = STRAIGHT_ROW[d] != 0 ? this->IsUnit(bi, bj - 1) || this->IsUnit(bi, bj + 1)
+					: this->IsUnit(bi - 1, bj) || this->IsUnit(bi + 1, bj);
+			}
+
+			if (subgoal) {
+				node[i * cols + j] = (uint32_t)subgoals.size();
+				subgoals.push_back(i * cols + j);
+			}
+		}
+	}
+
+	rowWords = (cols + 63) / 64;
+	colWords = (rows + 63) / 64;
+	openRows.assign(rows * rowWords, 0);
+	unitRows.assign(rows * rowWords, 0);
+	subgoalRows.assign(rows * rowWords, 0);
+	openCols.assign(cols * colWords, 0);
+	unitCols.assign(cols * colWords, 0);
+	subgoalCols.assign(cols * colWords, 0);
+
+	for (int i = 0; i < rows; i++) {
+		for (int j = 0; j < cols; j++) {
+			uint64_t rowBit = 1ull << (j & 63);
+			uint64_t colBit = 1ull << (i & 63);
+
+			if (!maze->isUnBlocked(i, j))
+				continue;
+
+			openRows[i * rowWords + (j >> 6)] |= rowBit;
+			openCols[j * colWords + (i >> 6)] |= colBit;
+
+			if (maze->getCellCost(i, j) == Maze::getMinCost()) {
+				unitRows[i * rowWords + (j >> 6)] |= rowBit;
+				unitCols[j * colWords + (i >> 6)] |= colBit;
+			}
+
+			if (node[i * cols + j] != NONE) {
+				subgoalRows[i * rowWords + (j >> 6)] |= rowBit;
+				subgoalCols[j * colWords + (i >> 6)] |= colBit;
+			}
+		}
+	}
+
+	uint32_t n = (uint32_t)subgoals.size();
+	ThreadPool pool(threads);
+	std::vector<rings> workspaces(pool.GetThreadCount());
+	std::vector<std::vector<edge>> out(n);
+
+	pool.ParallelFor(n, [&](uint32_t begin, uint32_t end, uint32_t thread) {
+		std::vector<std::pair<uint32_t, uint32_t>> reached;
+
+		for (uint32_t a = begin; a < end; a++) {
+			this->Reachable(subgoals[a], NONE, workspaces[thread], reached);
+
+			for (const std::pair<uint32_t, uint32_t>& r : reached) {
+				edge e = { node[r.first], (r.second - 1) * Maze::getMinCost() + maze->getCellCost(r.first / cols, r.first % cols) };
+				out[a].push_back(e);
+			}
+		}
+	}, 16);
+
+	edgeStart.assign(1, 0);
+	edges.clear();
+
+	for (uint32_t a = 0; a < n; a++) {
+		edges.insert(edges.end(), out[a].begin(), out[a].end());
+		edgeStart.push_back((uint32_t)edges.size());
+	}
+
+	search.stamp.assign(rows * cols, 0);
+	search.parent.assign(rows * cols, NONE);
+	search.current = 0;
+	this->Contract();
+
+	g.assign(n, 0);
+	parent.assign(n, NONE);
+	stamp.assign(n, 0);
+	toEnd.assign(n, NONE);
+	toEndNext.assign(n, NONE);
+	current = 0;
+	revision = maze->GetRevision();
+	built = true;
+}
+
+void SubgoalGraph::Contract()
+{
+	uint32_t n = (uint32_t)subgoals.size();
+	// The subgoals still global and the edges between them, both ways as reaching is symmetric
+	std::vector<std::vector<edge>> adjacent(n);
+	std::vector<uint32_t> order(n);
+
+	for (uint32_t a = 0; a < n; a++) {
+		adjacent[a].assign(edges.begin() + edgeStart[a], edges.begin() + edgeStart[a + 1]);
+		order[a] = a;
+	}
+
+	std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		return adjacent[a].size() != adjacent[b].size() ? adjacent[a].size() < adjacent[b].size() : a < b;
+	});
+
+	std::vector<uint32_t> distance(n, NONE);
+	std::vector<uint32_t> seen(n, 0);
+	std::vector<entry_t> heap;
+	uint32_t round = 0;
+
+	// Whether a path from a to b costing at most 'limit' avoids 'skip' and the edge a -> b.
+	// Only a few subgoals are settled: missing a path keeps a subgoal global or an edge, which is safe
+	auto witness = [&](uint32_t a, uint32_t b, uint32_t skip, uint32_t limit) {
+		round++;
+		heap.assign(1, entry_t(0, a));
+		distance[a] = 0;
+		seen[a] = round;
+
+		for (uint32_t settled = 0; !heap.empty() && settled < 16; settled++) {
+			std::pop_heap(heap.begin(), heap.end(), std::greater<entry_t>());
+			entry_t e = heap.back();
+			heap.pop_back();
+			uint32_t x = e.second;
+
+			if (e.first != distance[x])
+				continue;
+
+			if (x == b)
+				return true;
+
+			for (const edge& k : adjacent[x]) {
+				uint32_t cost = e.first + k.cost;
+
+				if (k.to == skip || (x == a && k.to == b) || cost > limit || (seen[k.to] == round && distance[k.to] <= cost))
+					continue;
+
+				seen[k.to] = round;
+				distance[k.to] = cost;
+				heap.push_back(entry_t(cost, k.to));
+				std::push_heap(heap.begin(), heap.end(), std::greater<entry_t>());
+			}
+		}
+
+		return false;
+	};
+
+	auto linked = [&](uint32_t a, uint32_t b) {
+		for (const edge& k : adjacent[a]) {
+			if (k.to == b)
+				return true;
+		}
+
+		return false;
+	};
+
+	// A subgoal becomes local when the paths through it between its neighbours are matched by
+	// another path or replaced by an edge, which the neighbours must then reach each other for.
+	// Every edge joins two subgoals reaching each other, so Refine turns any of them into cells
+	global.assign(n, 1);
+	std::vector<std::pair<uint32_t, uint32_t>> shortcuts;
+
+	for (uint32_t v : order) {
+		const std::vector<edge>& around = adjacent[v];
+		bool local = around.size() <= 8; // Keep the pairs few
+		shortcuts.clear();
+
+		for (size_t x = 0; x < around.size() && local; x++) {
+			for (size_t y = 0; y < around.size() && local; y++) {
+				uint32_t u = around[x].to;
+				uint32_t w = around[y].to;
+
+				if (u == w || linked(u, w) || witness(u, w, v, this->Hop(subgoals[u], subgoals[v]) + around[y].cost))
+					continue;
+
+				// Reaching each other is symmetric, keep one shortcut per pair. A walk cut short keeps v global
+				if (u < w && this->Walk(subgoals[u], subgoals[w], 4 * this->Distance(subgoals[u], subgoals[w])))
+					shortcuts.push_back(std::make_pair(u, w));
+				else if (u > w && this->Walk(subgoals[w], subgoals[u], 4 * this->Distance(subgoals[u], subgoals[w])))
+					continue;
+				else
+					local = false;
+
+				// Nor when it would add more edges than it removes
+				local = local && shortcuts.size() <= around.size();
+			}
+		}
+
+		if (!local)
+			continue;
+
+		for (const edge& k : around) {
+			std::vector<edge>& back = adjacent[k.to];
+
+			for (size_t x = 0; x < back.size(); x++) {
+				if (back[x].to == v) {
+					back[x] = back.back();
+					back.pop_back();
+					break;
+				}
+			}
+		}
+
+		for (const std::pair<uint32_t, uint32_t>& p : shortcuts) {
+			if (linked(p.first, p.second))
+				continue;
+
+			edge forth = { p.second, this->Hop(subgoals[p.first], subgoals[p.second]) };
+			edge back = { p.first, this->Hop(subgoals[p.second], subgoals[p.first]) };
+			adjacent[p.first].push_back(forth);
+			adjacent[p.second].push_back(back);
+		}
+
+		adjacent[v].clear();
+		adjacent[v].shrink_to_fit();
+		global[v] = 0;
+	}
+
+	// Then the edges matched by another path, whose edges are all cheaper as costs are positive
+	globalStart.assign(1, 0);
+	globalEdges.clear();
+
+	for (uint32_t a = 0; a < n; a++) {
+		for (size_t k = 0; k < adjacent[a].size(); ) {
+			if (witness(a, adjacent[a][k].to, NONE, adjacent[a][k].cost)) {
+				adjacent[a][k] = adjacent[a].back();
+				adjacent[a].pop_back();
+			} else {
+				k++;
+			}
+		}
+
+		globalEdges.insert(globalEdges.end(), adjacent[a].begin(), adjacent[a].end());
+		globalStart.push_back((uint32_t)globalEdges.size());
+	}
+}
+
+bool SubgoalGraph::Walk(uint32_t a, uint32_t b, uint32_t limit)
+{
+	if (++search.current == 0) {
+		std::fill(search.stamp.begin(), search.stamp.end(), 0);
+		search.current = 1;
+	}
+
+	// Depth first, every move one step closer to b, the move straight toward it first
+	search.queue.assign(1, a);
+	search.stamp[a] = search.current;
+	search.parent[a] = NONE;
+
+	for (uint32_t steps = 0; !search.queue.empty() && search.stamp[b] != search.current && steps < limit; steps++) {
+		uint32_t x = search.queue.back();
+		search.queue.pop_back();
+
+		int i = x / cols;
+		int j = x % cols;
+		int di = (b / cols > x / cols) - (b / cols < x / cols);
+		int dj = (b % cols > x % cols) - (b % cols < x % cols);
+		uint32_t straight = NONE;
+
+		for (int d = 0; d < 8; d++) {
+			int ni = i + DIR_ROW[d];
+			int nj = j + DIR_COL[d];
+
+			if (!maze->isValid(ni, nj) || !maze->isUnBlocked(ni, nj))
+				continue;
+
+			uint32_t y = ni * cols + nj;
+
+			if (search.stamp[y] == search.current || this->Distance(y, b) + 1 != this->Distance(x, b) || (y != b && maze->getCellCost(ni, nj) != Maze::getMinCost()))
+				continue;
+
+			search.stamp[y] = search.current;
+			search.parent[y] = x;
+
+			if (DIR_ROW[d] == di && DIR_COL[d] == dj)
+				straight = y;
+			else
+				search.queue.push_back(y);
+		}
+
+		if (straight != NONE)
+			search.queue.push_back(straight);
+	}
+
+	return search.stamp[b] == search.current;
+}
+
+void SubgoalGraph::Refine(uint32_t a, uint32_t b, std::vector<uint32_t>& route)
+{
+	this->Walk(a, b, NONE);
+	size_t first = route.size();
+
+	for (uint32_t x = b; x != a; x = search.parent[x])
+		route.push_back(x);
+
+	std::reverse(route.begin() + first, route.end());
+}
+
+std::stack<Pair> SubgoalGraph::Search(const Pair& s, const Pair& t, uint32_t& cost)
+{
+	std::stack<Pair> path;
+	cost = UINT32_MAX;
+	expanded = 0;
+
+	if (!built || !maze->isValid(s) || !maze->isValid(t) || !maze->isUnBlocked(s) || !maze->isUnBlocked(t))
+		return path;
+
+	uint32_t S = s.first * cols + s.second;
+	uint32_t T = t.first * cols + t.second;
+
+	if (S == T) {
+		cost = 0;
+		path.push(s);
+		return path;
+	}
+
+	if (++current == 0) {
+		std::fill(stamp.begin(), stamp.end(), 0);
+		current = 1;
+	}
+
+	std::vector<entry_t> openList;
+	std::vector<std::pair<uint32_t, uint32_t>> reached;
+	uint32_t best = NONE;
+	uint32_t last = NONE; // Subgoal before the end, NONE when the start reaches it directly
+
+	auto open = [&](uint32_t v, uint32_t cost, uint32_t from) {
+		if (stamp[v] != current || cost < g[v]) {
+			stamp[v] = current;
+			g[v] = cost;
+			parent[v] = from;
+			openList.push_back(entry_t(cost + this->Distance(subgoals[v], T) * Maze::getMinCost(), v));
+			std::push_heap(openList.begin(), openList.end(), std::greater<entry_t>());
+		}
+	};
+
+	// The subgoals the start reaches directly. Reaching the end that way is as cheap as it gets
+	if (node[S] != NONE) {
+		open(node[S], 0, NONE);
+	} else {
+		this->Reachable(S, T, ring, reached);
+
+		for (const std::pair<uint32_t, uint32_t>& r : reached) {
+			if (r.first == T)
+				best = (r.second - 1) * Maze::getMinCost() + maze->getCellCost(t.first, t.second);
+		}
+
+		for (const std::pair<uint32_t, uint32_t>& r : reached) {
+			if (best == NONE)
+				open(node[r.first], (r.second - 1) * Maze::getMinCost() + maze->getCellCost(r.first / cols, r.first % cols), NONE);
+		}
+	}
+
+	// Then the ones reaching the end directly, and the local subgoals leading to them backward
+	std::vector<uint32_t> ends;
+	std::vector<entry_t> endList;
+
+	if (best != NONE) {
+		// Nothing to search
+	} else if (node[T] != NONE) {
+		ends.push_back(node[T]);
+		toEnd[node[T]] = 0;
+		toEndNext[node[T]] = NONE;
+		endList.push_back(entry_t(0, node[T]));
+	} else {
+		this->Reachable(T, NONE, ring, reached);
+
+		for (const std::pair<uint32_t, uint32_t>& r : reached) {
+			uint32_t v = node[r.first];
+			ends.push_back(v);
+			toEnd[v] = (r.second - 1) * Maze::getMinCost() + maze->getCellCost(t.first, t.second);
+			toEndNext[v] = NONE;
+			endList.push_back(entry_t(toEnd[v], v));
+		}
+
+		std::make_heap(endList.begin(), endList.end(), std::greater<entry_t>());
+	}
+
+	// The edges of a local subgoal lead to it as well, from its own neighbours
+	while (!endList.empty()) {
+		std::pop_heap(endList.begin(), endList.end(), std::greater<entry_t>());
+		entry_t e = endList.back();
+		endList.pop_back();
+		uint32_t x = e.second;
+
+		if (e.first != toEnd[x] || global[x])
+			continue;
+
+		expanded++;
+
+		for (uint32_t k = edgeStart[x]; k < edgeStart[x + 1]; k++) {
+			uint32_t y = edges[k].to;
+			uint32_t cost = toEnd[x] + this->Hop(subgoals[y], subgoals[x]);
+
+			if (toEnd[y] == NONE)
+				ends.push_back(y);
+			else if (toEnd[y] <= cost)
+				continue;
+
+			toEnd[y] = cost;
+			toEndNext[y] = x;
+			endList.push_back(entry_t(cost, y));
+			std::push_heap(endList.begin(), endList.end(), std::greater<entry_t>());
+		}
+	}
+
+	while (!openList.empty() && openList.front().first < best) {
+		std::pop_heap(openList.begin(), openList.end(), std::greater<entry_t>());
+		entry_t e = openList.back();
+		openList.pop_back();
+		uint32_t x = e.second;
+
+		if (e.first != g[x] + this->Distance(subgoals[x], T) * Maze::getMinCost())
+			continue;
+
+		expanded++;
+
+		if (toEnd[x] != NONE && g[x] + toEnd[x] < best) {
+			best = g[x] + toEnd[x];
+			last = x;
+		}
+
+		// Past the subgoals near the start, the global graph only
+		if (global[x]) {
+			for (uint32_t k = globalStart[x]; k < globalStart[x + 1]; k++)
+				open(globalEdges[k].to, g[x] + globalEdges[k].cost, x);
+		} else {
+			for (uint32_t k = edgeStart[x]; k < edgeStart[x + 1]; k++)
+				open(edges[k].to, g[x] + edges[k].cost, x);
+		}
+	}
+
+	for (uint32_t v : ends)
+		toEnd[v] = NONE;
+
+	if (best == NONE)
+		return path;
+
+	cost = best;
+
+	// Subgoals from the start to the end, every hop refined into cells
+	std::vector<uint32_t> waypoints;
+
+	for (uint32_t v = last; v != NONE; v = parent[v])
+		waypoints.push_back(subgoals[v]);
+
+	if (waypoints.empty() || waypoints.back() != S)
+		waypoints.push_back(S);
+
+	std::reverse(waypoints.begin(), waypoints.end());
+
+	for (uint32_t v = last != NONE ? toEndNext[last] : NONE; v != NONE; v = toEndNext[v])
+		waypoints.push_back(subgoals[v]);
+
+	if (waypoints.back() != T)
+		waypoints.push_back(T);
+	std::vector<uint32_t> route(1, S);
+
+	for (uint32_t k = 0; k + 1 < waypoints.size(); k++)
+		this->Refine(waypoints[k], waypoints[k + 1], route);
+
+	for (std::vector<uint32_t>::reverse_iterator it = route.rbegin(); it != route.rend(); ++it)
+		path.push(Pair(*it / cols, *it % cols));
+
+	return path;
+}
\ No newline at end of file
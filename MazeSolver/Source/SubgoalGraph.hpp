@@ -0,0 +1,110 @@
+#pragma once
+
+#include "maze.hpp"
+#include <algorithm>
+#include <stack>
+#include <vector>
+
+class Maze;
+
+// Two-level subgoal graph for the moves of A* (8 directions, the cost of the cell entered).
+// The subgoals are the cells costing more than the cheapest type and the cells diagonal to the
+// end of a wall (or of such cells): anywhere else a cheapest path goes on as on an empty grid.
+// Two subgoals are joined when one reaches the other in as many moves as their Chebyshev
+// distance, unless another subgoal is on such a path. The subgoals the others do without become
+// local, and the global ones keep the edges between them only. A search joins the start and the
+// end to the subgoals they reach that way and to the global ones behind the local ones around
+// them, runs A* on the global subgoals and refines every edge into cells.
+class SubgoalGraph
+{
+public:
+	SubgoalGraph(Maze* maze);
+
+	// Place the subgoals and join them, in parallel
+	void Build(uint32_t threads = 0);
+
+	bool IsValid() const { return built && revision == maze->GetRevision(); }
+
+	// Cells from s (on top) to t, empty if there is no path. Cost is UINT32_MAX without path
+	std::stack<Pair> Search(const Pair& s, const Pair& t, uint32_t& cost);
+
+	// Subgoals expanded by the last search
+	uint32_t getExpanded() const { return expanded; }
+
+	uint32_t GetSubgoalCount() const { return (uint32_t)subgoals.size(); }
+
+	uint32_t GetEdgeCount() const { return (uint32_t)edges.size(); }
+
+	uint32_t GetGlobalCount() const { return (uint32_t)std::count(global.begin(), global.end(), 1); }
+
+	uint32_t GetGlobalEdgeCount() const { return (uint32_t)globalEdges.size(); }
+private:
+	struct edge
+	{
+		uint32_t to;
+		uint32_t cost;
+	};
+
+	// Depth-first search state of Walk
+	struct workspace
+	{
+		std::vector<uint32_t> stamp;
+		std::vector<uint32_t> parent;
+		std::vector<uint32_t> queue;
+		uint32_t current;
+	};
+
+	// Last ring of Reachable on each side (north, south, west, east): bits of the cells reached and of those covered
+	struct rings
+	{
+		std::vector<uint64_t> reached[4];
+		std::vector<uint64_t> covered[4];
+		std::vector<uint64_t> next[2];
+	};
+
+	// Subgoals (and 'target') reached from 'cell' in as many moves as their Chebyshev distance
+	// through cells that are not subgoals, as <cell, moves>
+	void Reachable(uint32_t cell, uint32_t target, rings& rs, std::vector<std::pair<uint32_t, uint32_t>>& result) const;
+
+	// Make local the subgoals whose neighbours do without them and keep the global graph
+	void Contract();
+
+	// Whether b is reachable from a within 'limit' cells expanded, leaving the cells in the search state
+	bool Walk(uint32_t a, uint32_t b, uint32_t limit);
+
+	// Append the cells after a up to b, b being reachable from a
+	void Refine(uint32_t a, uint32_t b, std::vector<uint32_t>& route);
+
+	uint32_t Distance(uint32_t a, uint32_t b) const;
+
+	// Cost of the edge from a to b
+	uint32_t Hop(uint32_t a, uint32_t b) const;
+
+	bool IsUnit(int row, int col) const;
+private:
+	Maze* maze;
+	uint32_t revision;
+	bool built;
+	int rows, cols;
+	uint32_t rowWords, colWords;
+	// Bits of the open cells, of the cells costing the least and of the subgoals, row by row and column by column
+	std::vector<uint64_t> openRows, unitRows, subgoalRows;
+	std::vector<uint64_t> openCols, unitCols, subgoalCols;
+	uint32_t expanded;
+	std::vector<uint32_t> node; // Cell -> subgoal, UINT32_MAX for the other cells
+	std::vector<uint32_t> subgoals; // Subgoal -> cell
+	std::vector<uint32_t> edgeStart;
+	std::vector<edge> edges;
+	std::vector<uint8_t> global; // 1 for the subgoals of the global graph
+	std::vector<uint32_t> globalStart;
+	std::vector<edge> globalEdges;
+	// Search state, only meaningful when stamp matches the current search
+	std::vector<uint32_t> g;
+	std::vector<uint32_t> parent;
+	std::vector<uint32_t> stamp;
+	std::vector<uint32_t> toEnd; // Cost from a subgoal to the end, when it reaches it directly or through local subgoals
+	std::vector<uint32_t> toEndNext; // Next subgoal on the way to the end, UINT32_MAX for the end itself
+	uint32_t current;
+	workspace search;
+	rings ring;
+};
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "Swamps.hpp"
+#include <algorithm>
+#include <cstdio>
+
+static constexpr uint32_t NONE = UINT32_MAX;
+
+static constexpr int DIR_ROW[] = { -1, 0, 0, 1, -1, -1, 1, 1 };
+static constexpr int DIR_COL[] = { 0, -1, 1, 0, -1, 1, -1, 1 };
+
+Swamps::Swamps(Maze* maze, Maze::moves_t moves) :
+	maze(maze), moves(moves), revision(0), built(false), cols(0), gates(0), skipped(0)
+{
+}
+
+void Swamps::Build()
+{
+	int ROW = maze->GetRows();
+	int COL = maze->GetCols();
+	int dirs = moves == Maze::MOVES_4 ? 4 : 8;
+
+	cols = COL;
+	order.assign(ROW * COL, NONE);
+	cells.clear();
+	cuts.clear();
+	gates = 0;
+
+	std::vector<uint32_t> low, size;
+	std::vector<uint8_t> gate;
+	std::vector<std::pair<uint32_t, int>> stack; // <cell, next move to try>
+
+	for (int c = 0; c < ROW * COL; c++) {
+		if (!maze->isUnBlocked(c / COL, c % COL) || order[c] != NONE)
+			continue;
+
+		order[c] = (uint32_t)cells.size();
+		cells.push_back(c);
+		low.push_back(order[c]);
+		size.push_back(1);
+		gate.push_back(0);
+		stack.push_back(std::make_pair((uint32_t)c, 0));
+
+		while (!stack.empty()) {
+			uint32_t v = stack.back().first;
+			int& d = stack.back().second;
+
+			if (d < dirs) {
+				int ni = v / COL + DIR_ROW[d];
+				int nj = v % COL + DIR_COL[d];
+				d++;
+
+				if (!maze->isValid(ni, nj) || !maze->isUnBlocked(ni, nj))
+					continue;
+
+				uint32_t w = ni * COL + nj;
+
+				if (order[w] == NONE) {
+					order[w] = (uint32_t)cells.size();
+					cells.push_back(w);
+					low.push_back(order[w]);
+					size.push_back(1);
+					gate.push_back(0);
+					stack.push_back(std::make_pair(w, 0));
+				} else {
+					low[order[v]] = std::min(low[order[v]], order[w]);
+				}
+
+				continue;
+			}
+
+			// Every neighbour done, report to the parent
+			stack.pop_back();
+
+			if (stack.empty())
+				break;
+
+			uint32_t p = order[stack.back().first];
+			uint32_t o = order[v];
+
+			low[p] = std::min(low[p], low[o]);
+			size[p] += size[o];
+
+			// Nothing below v goes above p: p is the only way into that region
+			if (low[o] >= p) {
+				cut region = { p, o, o + size[o] };
+				cuts.push_back(region);
+
+				// The root only splits the maze with two regions under it
+				if (++gate[p] == (p == order[c] ? 2 : 1))
+					gates++;
+			}
+		}
+	}
+}
+
+bool Swamps::Update(const Pair& start, const Pair& end)
+{
+	bool rebuilt = !built || revision != maze->GetRevision();
+
+	if (!rebuilt && start == this->start && end == this->end)
+		return false;
+
+	if (rebuilt) {
+		this->Build();
+		revision = maze->GetRevision();
+		built = true;
+	}
+
+	this->start = start;
+	this->end = end;
+
+	uint32_t n = (uint32_t)cells.size();
+	uint32_t s = maze->isValid(start) ? order[start.first * cols + start.second] : NONE;
+	uint32_t t = maze->isValid(end) ? order[end.first * cols + end.second] : NONE;
+	std::vector<int32_t> count(n + 1, 0);
+
+	// A region without the start and the end is a swamp, and so is the rest of the maze when both are in it (but the gate)
+	for (const cut& region : cuts) {
+		bool s_in = s >= region.first && s < region.last;
+		bool t_in = t >= region.first && t < region.last;
+
+		if (!s_in && !t_in) {
+			count[region.first]++;
+			count[region.last]--;
+		} else if (s_in && t_in) {
+			count[0]++;
+			count[region.first]--;
+			count[region.last]++;
+			count[n]--;
+			count[region.gate]--;
+			count[region.gate + 1]++;
+		}
+	}
+
+	swamp.assign(maze->GetRows() * cols, 0);
+	skipped = 0;
+
+	for (uint32_t o = 0, sum = 0; o < n; o++) {
+		sum += count[o];
+
+		if (sum > 0 && o != s && o != t) {
+			swamp[cells[o]] = 1;
+			skipped++;
+		}
+	}
+
+	printf("Swamps (%s): %u gates, skipped %u of %u open cells (%.1f%%)\n", moves == Maze::MOVES_4 ? "4 directions" : "8 directions",
+		gates, skipped, n, n > 0 ? 100.f * skipped / n : 0.f);
+
+	return true;
+}
\ No newline at end of file
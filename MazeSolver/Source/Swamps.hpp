@@ -0,0 +1,48 @@
+#pragma once
+
+#include "maze.hpp"
+#include <vector>
+
+class Maze;
+
+// Swamps: regions of the maze entered and left through a single cell (a gate), that a cheapest
+// path never goes through unless it starts or ends inside. The gates are the articulation points
+// of the open cells, found with an iterative Tarjan search; the region cut off by a gate is a
+// range of the depth-first order, so marking the swamps of a start and an end is linear.
+class Swamps
+{
+public:
+	Swamps(Maze* maze, Maze::moves_t moves);
+
+	// Mark the swamps again if the maze, the start or the end changed, returns true if it did
+	bool Update(const Pair& start, const Pair& end);
+
+	bool IsSwamp(int row, int col) const { return swamp[row * cols + col] != 0; }
+
+	bool IsSwamp(const Pair& cell) const { return IsSwamp(cell.first, cell.second); }
+
+	uint32_t GetGateCount() const { return gates; }
+
+	uint32_t getSkippedCount() const { return skipped; }
+private:
+	void Build();
+private:
+	struct cut
+	{
+		uint32_t gate; // Order of the gate
+		uint32_t first, last; // Orders of the region cut off
+	};
+private:
+	Maze* maze;
+	Maze::moves_t moves;
+	uint32_t revision;
+	bool built;
+	Pair start, end;
+	int cols;
+	uint32_t gates;
+	uint32_t skipped;
+	std::vector<uint32_t> order; // Cell -> depth-first order (UINT32_MAX for walls)
+	std::vector<uint32_t> cells; // Order -> cell
+	std::vector<cut> cuts;
+	std::vector<uint8_t> swamp;
+};
\ No newline at end of file
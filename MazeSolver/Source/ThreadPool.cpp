@@ -0,0 +1,103 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(uint32_t threads) : task(NULL), count(0), grain(1), next(0), running(0), generation(0), stop(false)
+{
+	if (threads == 0)
+		threads = DefaultThreadCount();
+
+	for (uint32_t i = 1; i < threads; i++) {
+		workers.push_back(std::thread(&ThreadPool::Worker, this, i));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+
+	wake.notify_all();
+
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+uint32_t ThreadPool::DefaultThreadCount()
+{
+	uint32_t threads = std::thread::hardware_concurrency();
+	return threads > 0 ? threads : 1;
+}
+
+void ThreadPool::ParallelFor(uint32_t count, const task_t& task, uint32_t grain)
+{
+	if (count == 0)
+		return;
+
+	if (grain == 0)
+		grain = (count + GetThreadCount() - 1) / GetThreadCount();
+
+	if (workers.empty() || count <= grain) { // Not worth waking anybody
+		task(0, count, 0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->task = &task;
+		this->count = count;
+		this->grain = grain;
+		this->next = 0;
+		this->running = (uint32_t)workers.size();
+		generation++;
+	}
+
+	wake.notify_all();
+	this->Run(0);
+
+	// Wait for the workers to finish their last range
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [this] { return running == 0; });
+	this->task = NULL;
+}
+
+// Take ranges until there is nothing left
+void ThreadPool::Run(uint32_t thread)
+{
+	while (true) {
+		uint32_t begin = next.fetch_add(grain);
+
+		if (begin >= count)
+			break;
+
+		(*task)(begin, std::min(begin + grain, count), thread);
+	}
+}
+
+void ThreadPool::Worker(uint32_t thread)
+{
+	uint64_t seen = 0;
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this, seen] { return stop || generation != seen; });
+
+			if (stop)
+				return;
+
+			seen = generation;
+		}
+
+		this->Run(thread);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			if (--running == 0)
+				done.notify_one();
+		}
+	}
+}
\ No newline at end of file
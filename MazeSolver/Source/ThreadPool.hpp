@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <stdint.h>
+
+// Fixed set of worker threads running parallel loops.
+// The calling thread takes part in the work as thread 0.
+class ThreadPool
+{
+public:
+	// Called with a range [begin, end) and the index of the thread running it
+	typedef std::function<void(uint32_t, uint32_t, uint32_t)> task_t;
+
+	ThreadPool(uint32_t threads = 0); // 0: one thread per core
+
+	~ThreadPool();
+
+	// Run the task over [0, count) in ranges of 'grain' items (0: one range per thread), returns when all are done
+	void ParallelFor(uint32_t count, const task_t& task, uint32_t grain = 0);
+
+	uint32_t GetThreadCount() const { return (uint32_t)workers.size() + 1; }
+
+	// Number of threads used when 0 is asked
+	static uint32_t DefaultThreadCount();
+private:
+	void Run(uint32_t thread);
+
+	void Worker(uint32_t thread);
+private:
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	const task_t* task;
+	uint32_t count;
+	uint32_t grain;
+	std::atomic<uint32_t> next;
+	uint32_t running;
+	uint64_t generation;
+	bool stop;
+};
\ No newline at end of file
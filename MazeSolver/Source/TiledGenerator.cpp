@@ -0,0 +1,103 @@
+#include "TiledGenerator.hpp"
+#include "ThreadPool.hpp"
+
+TiledGenerator::TiledGenerator(Maze* maze, uint32_t size) : maze(maze), size(size > 0 ? size : 1)
+{
+}
+
+uint32_t TiledGenerator::Find(uint32_t tile)
+{
+	while (parent[tile] != tile) {
+		parent[tile] = parent[parent[tile]]; // Path halving
+		tile = parent[tile];
+	}
+
+	return tile;
+}
+
+void TiledGenerator::Build(uint64_t seed, uint32_t threads)
+{
+	Maze::MazeArray& grid = maze->GetMazeArray();
+	int ROW = maze->GetRows();
+	int COL = maze->GetCols();
+
+	// Cells on the odd rows and columns, as Maze::BuildMaze
+	uint32_t cellRows = ROW > 2 ? (ROW - 1) / 2 : 0;
+	uint32_t cellCols = COL > 2 ? (COL - 1) / 2 : 0;
+	uint32_t tileRows = (cellRows + size - 1) / size;
+	uint32_t tileCols = (cellCols + size - 1) / size;
+	uint32_t tiles = tileRows * tileCols;
+
+	if (tiles == 0)
+		return;
+
+	ThreadPool pool(threads);
+
+	// The tiles don't share any cell or wall, each one digs its own
+	pool.ParallelFor(tiles, [&](uint32_t begin, uint32_t end, uint32_t) {
+		for (uint32_t t = begin; t < end; t++) {
+			int top = 2 * (t / tileCols) * size + 1;
+			int left = 2 * (t % tileCols) * size + 1;
+			int bottom = 2 * std::min(cellRows, (t / tileCols + 1) * size);
+			int right = 2 * std::min(cellCols, (t % tileCols + 1) * size);
+			Random rng(seed + 1 + t);
+
+			for (int r = top; r < bottom; r += 2) {
+				for (int c = left; c < right; c += 2)
+					grid.Set(r, c, Maze::TRACE);
+			}
+
+			// Start anywhere in the tile
+			int r = top + 2 * rng((bottom - top + 1) / 2);
+			int c = left + 2 * rng((right - left + 1) / 2);
+			maze->DigMaze(r, c, top, left, bottom, right, rng);
+		}
+	}, 1);
+
+	// Borders between two tiles: the right one of a tile (2 * t) and its bottom one (2 * t + 1)
+	Random rng(seed);
+	std::vector<uint32_t> borders;
+
+	for (uint32_t t = 0; t < tiles; t++) {
+		if (t % tileCols + 1 < tileCols)
+			borders.push_back(2 * t);
+
+		if (t / tileCols + 1 < tileRows)
+			borders.push_back(2 * t + 1);
+	}
+
+	// Kruskal over the tiles: every border joining two groups of tiles gets an opening
+	for (uint32_t i = (uint32_t)borders.size(); i > 1; i--)
+		std::swap(borders[i - 1], borders[rng(i)]);
+
+	parent.resize(tiles);
+
+	for (uint32_t t = 0; t < tiles; t++)
+		parent[t] = t;
+
+	for (uint32_t border : borders) {
+		uint32_t t = border / 2;
+		bool down = (border & 1) != 0;
+		uint32_t a = this->Find(t);
+		uint32_t b = this->Find(down ? t + tileCols : t + 1);
+
+		if (a == b)
+			continue;
+
+		parent[std::max(a, b)] = std::min(a, b);
+
+		// A random cell along the border, the wall next to it is opened
+		uint32_t row = t / tileCols;
+		uint32_t col = t % tileCols;
+
+		if (down) {
+			uint32_t first = col * size;
+			uint32_t cell = first + rng(std::min(cellCols, first + size) - first);
+			grid.Set(2 * (row + 1) * size, 2 * cell + 1, Maze::getRandomCell(rng));
+		} else {
+			uint32_t first = row * size;
+			uint32_t cell = first + rng(std::min(cellRows, first + size) - first);
+			grid.Set(2 * cell + 1, 2 * (col + 1) * size, Maze::getRandomCell(rng));
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "maze.hpp"
+
+class Maze;
+
+// Parallel maze generation: the cells are split in square tiles, every tile gets its own
+// depth first maze (Maze::DigMaze inside the tile) from a generator seeded by the tile, then
+// a random spanning tree over the tiles decides where two tiles are joined, through a single
+// opening on their common border. Every step only depends on the seed, so the maze is the
+// same whatever the number of threads.
+class TiledGenerator
+{
+public:
+	TiledGenerator(Maze* maze, uint32_t size = 64);
+
+	// Fill a maze made of walls only
+	void Build(uint64_t seed, uint32_t threads = 0);
+private:
+	uint32_t Find(uint32_t tile);
+private:
+	Maze* maze;
+	uint32_t size; // Tile side, in cells
+	std::vector<uint32_t> parent; // Tiles already joined
+};
\ No newline at end of file
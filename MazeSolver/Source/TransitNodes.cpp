@@ -0,0 +1,608 @@
+#include "TransitNodes.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+constexpr uint32_t TransitNodes::MAX_NODES;
+constexpr uint32_t TransitNodes::FAR;
+
+static constexpr uint32_t NONE = UINT32_MAX;
+
+// Rings around a block, in blocks: the access nodes are on the inner one, the paths they come from reach the outer one
+static constexpr uint32_t INNER = 1;
+static constexpr uint32_t OUTER = 2;
+
+// Moves of Dijkstra
+static constexpr int DIR_ROW[] = { -1, 0, 0, 1 };
+static constexpr int DIR_COL[] = { 0, -1, 1, 0 };
+
+typedef std::pair<uint32_t, uint32_t> entry_t; // <distance, cell or node>
+
+TransitNodes::TransitNodes(Maze* maze, uint32_t size) :
+	maze(maze), fixed(size), revision(0), built(false), usable(false), size(0), rows(0), cols(0), blockRows(0), blockCols(0), lookups(0)
+{
+}
+
+bool TransitNodes::IsAround(uint32_t cell, uint32_t b, uint32_t radius) const
+{
+	int di = (int)(cell / cols / size) - (int)(b / blockCols);
+	int dj = (int)((cell % cols) / size) - (int)(b % blockCols);
+
+	return (uint32_t)std::abs(di) <= radius && (uint32_t)std::abs(dj) <= radius;
+}
+
+bool TransitNodes::IsNode(uint32_t cell) const
+{
+	int i = cell / cols;
+	int j = cell % cols;
+
+	if (!maze->isUnBlocked(i, j))
+		return false;
+
+	for (int d = 0; d < 4; d++) {
+		int ni = i + DIR_ROW[d];
+		int nj = j + DIR_COL[d];
+
+		if (maze->isValid(ni, nj) && maze->isUnBlocked(ni, nj) && this->BlockOf(ni * cols + nj) != this->BlockOf(cell))
+			return true;
+	}
+
+	return false;
+}
+
+void TransitNodes::Local(uint32_t cell, bool backward, uint32_t radius, uint32_t target, workspace& ws) const
+{
+	uint32_t b = this->BlockOf(cell);
+
+	if (++ws.current == 0) {
+		std::fill(ws.stamp.begin(), ws.stamp.end(), 0);
+		std::fill(ws.seen.begin(), ws.seen.end(), 0);
+		ws.current = 1;
+	}
+
+	// With a target, A*: every move costs at least the cheapest cell
+	auto estimate = [this, target](uint32_t c) {
+		if (target == NONE)
+			return 0u;
+
+		return (uint32_t)(std::abs((int)(c / cols) - (int)(target / cols)) + std::abs((int)(c % cols) - (int)(target % cols))) * Maze::getMinCost();
+	};
+
+	ws.openList.clear();
+	ws.dist[cell] = 0;
+	ws.parent[cell] = NONE;
+	ws.stamp[cell] = ws.current;
+	ws.openList.push_back(entry_t(estimate(cell), cell));
+
+	while (!ws.openList.empty()) {
+		std::pop_heap(ws.openList.begin(), ws.openList.end(), std::greater<entry_t>());
+		entry_t e = ws.openList.back();
+		ws.openList.pop_back();
+
+		if (e.first != ws.dist[e.second] + estimate(e.second))
+			continue;
+
+		if (e.second == target)
+			break;
+
+		int i = e.second / cols;
+		int j = e.second % cols;
+
+		for (int d = 0; d < 4; d++) {
+			int ni = i + DIR_ROW[d];
+			int nj = j + DIR_COL[d];
+			uint32_t next = ni * cols + nj;
+
+			if (!maze->isValid(ni, nj) || !maze->isUnBlocked(ni, nj) || (radius != NONE && !this->IsAround(next, b, radius)))
+				continue;
+
+			// Going backward, the move from the neighbour enters the current cell
+			uint32_t nd = ws.dist[e.second] + (backward ? maze->getCellCost(i, j) : maze->getCellCost(ni, nj));
+
+			if (ws.stamp[next] != ws.current || nd < ws.dist[next]) {
+				ws.stamp[next] = ws.current;
+				ws.dist[next] = nd;
+				ws.parent[next] = e.second;
+				ws.openList.push_back(entry_t(nd + estimate(next), next));
+				std::push_heap(ws.openList.begin(), ws.openList.end(), std::greater<entry_t>());
+			}
+		}
+	}
+}
+
+void TransitNodes::Prepare(uint32_t b, workspace& ws)
+{
+	block& blk = blocks[b];
+	int top = (b / blockCols) * size;
+	int left = (b % blockCols) * size;
+
+	blk.nodes.clear();
+
+	for (int i = top; i < std::min(rows, top + (int)size); i++) {
+		for (int j = left; j < std::min(cols, left + (int)size); j++) {
+			if (this->IsNode(i * cols + j))
+				blk.nodes.push_back(i * cols + j);
+		}
+	}
+
+	uint32_t k = (uint32_t)blk.nodes.size();
+	blk.table.assign(k * k, NONE);
+
+	for (uint32_t a = 0; a < k; a++) {
+		this->Local(blk.nodes[a], false, 0, NONE, ws);
+
+		for (uint32_t c = 0; c < k; c++) {
+			if (ws.stamp[blk.nodes[c]] == ws.current)
+				blk.table[a * k + c] = ws.dist[blk.nodes[c]];
+		}
+	}
+}
+
+void TransitNodes::Access(uint32_t b, workspace& ws)
+{
+	block& blk = blocks[b];
+	int top = (int)(b / blockCols) * (int)size - (int)(OUTER * size);
+	int left = (int)(b % blockCols) * (int)size - (int)(OUTER * size);
+	int bottom = top + (int)((2 * OUTER + 1) * size) - 1;
+	int right = left + (int)((2 * OUTER + 1) * size) - 1;
+
+	// The open cells on the sides of the outer ring, unless the maze ends there
+	std::vector<uint32_t> targets;
+
+	for (int i = std::max(0, top); i <= std::min(rows - 1, bottom); i++) {
+		for (int j = std::max(0, left); j <= std::min(cols - 1, right); j++) {
+			bool side = (i == top && i > 0) || (i == bottom && i < rows - 1) || (j == left && j > 0) || (j == right && j < cols - 1);
+
+			if (side && maze->isUnBlocked(i, j))
+				targets.push_back(i * cols + j);
+		}
+	}
+
+	// A cheapest path from the border of the block to the outer ring, searched within it, leaves
+	// the inner ring for the last time at an access node. Cheapest paths between two cells are the
+	// same both ways (costs only differ by the cells at the ends), so these nodes serve the paths
+	// into the block as well. The cells already traced back from the current border cell stop the next traces
+	blk.access.clear();
+
+	for (uint32_t source : blk.nodes) {
+		this->Local(source, false, OUTER, NONE, ws);
+
+		for (uint32_t target : targets) {
+			if (ws.stamp[target] != ws.current)
+				continue;
+
+			uint32_t c = target;
+
+			while (ws.seen[c] != ws.current && !this->IsAround(c, b, INNER)) {
+				ws.seen[c] = ws.current;
+				c = ws.parent[c];
+			}
+
+			if (ws.seen[c] != ws.current) {
+				ws.seen[c] = ws.current;
+				blk.access.push_back(c);
+			}
+		}
+	}
+
+	std::sort(blk.access.begin(), blk.access.end());
+	blk.access.erase(std::unique(blk.access.begin(), blk.access.end()), blk.access.end());
+}
+
+bool TransitNodes::Connect()
+{
+	// The border cells are the nodes of the searches over the block tables
+	std::vector<uint32_t> border; // Node -> cell
+	std::vector<uint32_t> node(rows * cols, NONE); // Cell -> node
+
+	cells.clear();
+	index.assign(rows * cols, NONE);
+
+	for (const block& blk : blocks) {
+		for (uint32_t cell : blk.nodes) {
+			node[cell] = (uint32_t)border.size();
+			border.push_back(cell);
+		}
+
+		for (uint32_t cell : blk.access) {
+			if (index[cell] == NONE) {
+				index[cell] = (uint32_t)cells.size();
+				cells.push_back(cell);
+			}
+		}
+	}
+
+	uint32_t N = (uint32_t)cells.size();
+
+	if (N > MAX_NODES) {
+		printf("The maze has %u transit nodes with blocks of %u, the tables handle up to %u\n", N, size, MAX_NODES);
+		dist.clear();
+		via.clear();
+		return false;
+	}
+
+	// Arcs between the border cells: across a block through its table, or a move into the next block
+	std::vector<uint32_t> start(1, 0), next, cost;
+
+	for (uint32_t b = 0; b < blocks.size(); b++) {
+		const block& blk = blocks[b];
+		uint32_t k = (uint32_t)blk.nodes.size();
+
+		for (uint32_t a = 0; a < k; a++) {
+			for (uint32_t c = 0; c < k; c++) {
+				if (c != a && blk.table[a * k + c] != NONE) {
+					next.push_back(node[blk.nodes[c]]);
+					cost.push_back(blk.table[a * k + c]);
+				}
+			}
+
+			int i = blk.nodes[a] / cols;
+			int j = blk.nodes[a] % cols;
+
+			for (int d = 0; d < 4; d++) {
+				int ni = i + DIR_ROW[d];
+				int nj = j + DIR_COL[d];
+
+				if (maze->isValid(ni, nj) && maze->isUnBlocked(ni, nj) && this->BlockOf(ni * cols + nj) != b) {
+					next.push_back(node[ni * cols + nj]);
+					cost.push_back(maze->getCellCost(ni, nj));
+				}
+			}
+
+			start.push_back((uint32_t)next.size());
+		}
+	}
+
+	uint32_t M = (uint32_t)border.size();
+	dist.assign(N * N, NONE);
+	via.assign(N * N, 0);
+
+	ThreadPool pool(maze->GetThreadCount());
+	std::vector<std::vector<entry_t>> openList(pool.GetThreadCount());
+	std::vector<std::vector<uint32_t>> distance(pool.GetThreadCount());
+	std::vector<std::vector<uint16_t>> last(pool.GetThreadCount());
+
+	// One search per transit node over all the border cells, every thread fills its own rows.
+	// A border cell remembers the last transit node on its way
+	pool.ParallelFor(N, [&](uint32_t begin, uint32_t end, uint32_t thread) {
+		std::vector<entry_t>& q = openList[thread];
+		std::vector<uint32_t>& d = distance[thread];
+		std::vector<uint16_t>& p = last[thread];
+
+		for (uint32_t s = begin; s < end; s++) {
+			uint32_t from = node[cells[s]];
+
+			d.assign(M, NONE);
+			p.assign(M, 0);
+			q.clear();
+			d[from] = 0;
+			p[from] = (uint16_t)s;
+			q.push_back(entry_t(0, from));
+
+			while (!q.empty()) {
+				std::pop_heap(q.begin(), q.end(), std::greater<entry_t>());
+				entry_t e = q.back();
+				q.pop_back();
+
+				if (e.first != d[e.second])
+					continue;
+
+				uint32_t through = index[border[e.second]];
+
+				for (uint32_t k = start[e.second]; k < start[e.second + 1]; k++) {
+					uint32_t v = next[k];
+
+					if (e.first + cost[k] < d[v]) {
+						d[v] = e.first + cost[k];
+						p[v] = through != NONE ? (uint16_t)through : p[e.second];
+						q.push_back(entry_t(d[v], v));
+						std::push_heap(q.begin(), q.end(), std::greater<entry_t>());
+					}
+				}
+			}
+
+			for (uint32_t t = 0; t < N; t++) {
+				dist[s * N + t] = d[node[cells[t]]];
+				via[s * N + t] = p[node[cells[t]]];
+			}
+		}
+	}, 8);
+
+	// The steps from a transit node to the next one on the paths of the table, searched once for the queries
+	std::vector<uint32_t> from, mark(N, NONE);
+	stepStart.assign(N + 1, 0);
+	stepTo.clear();
+
+	for (uint32_t t = 0; t < N; t++) {
+		for (uint32_t s = 0; s < N; s++) {
+			uint32_t x = via[s * N + t];
+
+			if (x != t && dist[s * N + t] != NONE && mark[x] != t) {
+				mark[x] = t;
+				from.push_back(x);
+				stepTo.push_back(t);
+				stepStart[x + 1]++;
+			}
+		}
+	}
+
+	for (uint32_t x = 0; x < N; x++)
+		stepStart[x + 1] += stepStart[x];
+
+	// Grouped by the transit node they leave
+	std::vector<uint32_t> order(stepTo.size()), fill(stepStart.begin(), stepStart.end() - 1);
+
+	for (uint32_t k = 0; k < stepTo.size(); k++)
+		order[fill[from[k]]++] = k;
+
+	std::vector<uint32_t> to(stepTo.size());
+	std::vector<std::vector<uint32_t>> route(stepTo.size());
+
+	for (uint32_t k = 0; k < order.size(); k++)
+		to[k] = stepTo[order[k]];
+
+	stepTo.swap(to);
+
+	pool.ParallelFor((uint32_t)stepTo.size(), [&](uint32_t begin, uint32_t end, uint32_t thread) {
+		workspace& ws = workspaces[thread];
+
+		for (uint32_t k = begin; k < end; k++) {
+			uint32_t a = cells[from[order[k]]];
+			uint32_t b = cells[stepTo[k]];
+			this->Local(a, false, NONE, b, ws);
+
+			for (uint32_t c = b; c != a; c = ws.parent[c])
+				route[k].push_back(c);
+
+			std::reverse(route[k].begin(), route[k].end());
+		}
+	}, 64);
+
+	stepBegin.assign(1, 0);
+	stepCells.clear();
+
+	for (const std::vector<uint32_t>& r : route) {
+		stepCells.insert(stepCells.end(), r.begin(), r.end());
+		stepBegin.push_back((uint32_t)stepCells.size());
+	}
+
+	return true;
+}
+
+bool TransitNodes::Update()
+{
+	uint32_t now = maze->GetRevision();
+
+	if (built && revision == now)
+		return usable;
+
+	auto begin = std::chrono::steady_clock::now();
+	const std::vector<Maze::edit_t>& edits = maze->GetEdits();
+	bool incremental = built && usable && rows == maze->GetRows() && cols == maze->GetCols() &&
+		revision >= maze->GetEditsBase() && now - maze->GetEditsBase() == edits.size();
+	std::vector<uint8_t> dirty; // 1: prepare the block again, 2: find its access nodes again
+
+	if (!incremental) {
+		rows = maze->GetRows();
+		cols = maze->GetCols();
+	}
+
+	ThreadPool pool(maze->GetThreadCount());
+	workspaces.resize(pool.GetThreadCount());
+
+	auto reserve = [this](workspace& ws) {
+		if (ws.dist.size() != (size_t)rows * cols) {
+			ws.dist.assign(rows * cols, 0);
+			ws.parent.assign(rows * cols, NONE);
+			ws.stamp.assign(rows * cols, 0);
+			ws.seen.assign(rows * cols, 0);
+			ws.current = 0;
+		}
+	};
+
+	reserve(search[0]);
+	reserve(search[1]);
+
+	for (workspace& ws : workspaces)
+		reserve(ws);
+
+	std::vector<uint32_t> todo;
+
+	auto refresh = [&](std::vector<std::atomic<uint8_t>>* marked, std::atomic<uint32_t>* count) {
+		todo.clear();
+
+		for (uint32_t b = 0; b < blocks.size(); b++) {
+			if (dirty[b])
+				todo.push_back(b);
+		}
+
+		pool.ParallelFor((uint32_t)todo.size(), [&](uint32_t begin, uint32_t end, uint32_t thread) {
+			for (uint32_t i = begin; i < end && !(count && *count > MAX_NODES); i++) {
+				uint32_t b = todo[i];
+
+				if (dirty[b] & 1)
+					this->Prepare(b, workspaces[thread]);
+
+				if (dirty[b] & 2)
+					this->Access(b, workspaces[thread]);
+
+				if (marked) {
+					for (uint32_t cell : blocks[b].access) {
+						if (!(*marked)[cell].exchange(1))
+							(*count)++;
+					}
+				}
+			}
+		}, 1);
+	};
+
+	if (incremental) {
+		// An edit changes the paths inside its block and which cells are border cells next to it,
+		// and the access nodes of the blocks whose outer ring holds it
+		dirty.assign(blocks.size(), 0);
+
+		for (uint32_t k = revision - maze->GetEditsBase(); k < edits.size(); k++) {
+			const Pair& cell = edits[k].cell;
+			dirty[this->BlockOf(cell.first * cols + cell.second)] |= 1;
+
+			for (int d = 0; d < 4; d++) {
+				int ni = cell.first + DIR_ROW[d];
+				int nj = cell.second + DIR_COL[d];
+
+				if (maze->isValid(ni, nj))
+					dirty[this->BlockOf(ni * cols + nj)] |= 1;
+			}
+
+			for (uint32_t b = 0; b < blocks.size(); b++) {
+				if (this->IsAround(cell.first * cols + cell.second, b, OUTER))
+					dirty[b] |= 2;
+			}
+		}
+
+		refresh(NULL, NULL);
+	} else {
+		// Larger blocks have fewer access nodes, but not so large that most queries are close
+		uint32_t largest = std::max(8u, (uint32_t)std::max(rows, cols) / 8);
+		size = fixed ? fixed : 8;
+
+		while (true) {
+			blockRows = (rows + size - 1) / size;
+			blockCols = (cols + size - 1) / size;
+			blocks.assign(blockRows * blockCols, block());
+			dirty.assign(blocks.size(), 3);
+
+			// Counting the transit nodes as the blocks go stops them early when there are too many
+			std::vector<std::atomic<uint8_t>> marked(rows * cols);
+			std::atomic<uint32_t> count(0);
+			refresh(&marked, &count);
+
+			if (count <= MAX_NODES)
+				break;
+
+			if (fixed || size * 2 > largest) {
+				printf("The maze has more than %u transit nodes with blocks of %u, the tables handle up to %u\n", MAX_NODES, size, MAX_NODES);
+				cells.clear();
+				dist.clear();
+				via.clear();
+				revision = now;
+				built = true;
+				usable = false;
+				return false;
+			}
+
+			size *= 2;
+		}
+	}
+
+	revision = now;
+	built = true;
+	usable = this->Connect();
+
+	// Too many transit nodes after the edits, larger blocks may do
+	if (!usable && incremental && !fixed) {
+		built = false;
+		return this->Update();
+	}
+
+	if (usable) {
+		printf("Transit nodes: %u of %u blocks of %ux%u prepared, %u nodes, tables ready in %.1f ms\n", (uint32_t)todo.size(), (uint32_t)blocks.size(),
+			size, size, (uint32_t)cells.size(), std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+	}
+
+	return usable;
+}
+
+std::stack<Pair> TransitNodes::Query(const Pair& s, const Pair& t, uint32_t& cost)
+{
+	std::stack<Pair> res;
+	cost = NONE;
+	lookups = 0;
+
+	if (!usable || !maze->isValid(s) || !maze->isValid(t) || !maze->isUnBlocked(s) || !maze->isUnBlocked(t))
+		return res;
+
+	uint32_t source = s.first * cols + s.second;
+	uint32_t target = t.first * cols + t.second;
+	uint32_t N = (uint32_t)cells.size();
+	workspace& forward = search[0];
+	workspace& backward = search[1];
+	uint32_t exit = NONE, entry = NONE;
+
+	if (this->IsAround(target, this->BlockOf(source), FAR - 1)) {
+		// Too close for the access nodes, the path may never leave the blocks around
+		this->Local(source, false, NONE, target, forward);
+
+		if (forward.stamp[target] == forward.current)
+			cost = forward.dist[target];
+	} else {
+		// Out of the start through an access node of its block, and into the end through one of its own
+		this->Local(source, false, OUTER, NONE, forward);
+		this->Local(target, true, OUTER, NONE, backward);
+
+		for (uint32_t a : blocks[this->BlockOf(source)].access) {
+			if (forward.stamp[a] != forward.current)
+				continue;
+
+			for (uint32_t b : blocks[this->BlockOf(target)].access) {
+				if (backward.stamp[b] != backward.current)
+					continue;
+
+				uint32_t d = dist[index[a] * N + index[b]];
+				lookups++;
+
+				if (d != NONE && forward.dist[a] + d + backward.dist[b] < cost) {
+					cost = forward.dist[a] + d + backward.dist[b];
+					exit = a;
+					entry = b;
+				}
+			}
+		}
+	}
+
+
+	if (cost == NONE)
+		return res;
+
+	std::vector<uint32_t> path;
+
+	// From the start to the exit (or the end)
+	for (uint32_t c = exit == NONE ? target : exit; c != NONE; c = forward.parent[c])
+		path.push_back(c);
+
+	std::reverse(path.begin(), path.end());
+
+	if (exit != NONE) {
+		// Transit nodes of the global table, the cells of every step between two of them are kept
+		std::vector<uint32_t> hops;
+
+		for (uint32_t n = index[entry]; n != index[exit]; n = via[index[exit] * N + n])
+			hops.push_back(n);
+
+		std::reverse(hops.begin(), hops.end());
+		uint32_t last = index[exit];
+
+		for (uint32_t n : hops) {
+			uint32_t k = stepStart[last];
+
+			while (stepTo[k] != n)
+				k++;
+
+			path.insert(path.end(), stepCells.begin() + stepBegin[k], stepCells.begin() + stepBegin[k + 1]);
+			last = n;
+		}
+
+		// Then to the end, the backward parents lead to it
+		for (uint32_t c = backward.parent[entry]; c != NONE; c = backward.parent[c])
+			path.push_back(c);
+	}
+
+
+	for (auto it = path.rbegin(); it != path.rend(); ++it)
+		res.push(std::make_pair(*it / cols, *it % cols));
+
+	return res;
+}
\ No newline at end of file
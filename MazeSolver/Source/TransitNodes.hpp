@@ -0,0 +1,106 @@
+#pragma once
+
+#include "maze.hpp"
+#include <stack>
+#include <vector>
+
+class Maze;
+
+// Transit nodes over a partition of the maze in square blocks, same moves and costs as Dijkstra.
+// Every block keeps the distances between its border cells (the open cells with a neighbour in
+// another block), searched inside the block. The access nodes of a block are the cells where the
+// cheapest paths from its border to the cells two blocks away cross the ring one block around it:
+// any cheapest path from the block to a cell farther away can go through one of them. The transit
+// nodes are all the access nodes, and a global table holds the distances between them, from one
+// search per node over the block tables and the moves between blocks. A query between blocks at
+// least FAR apart is a search from the start and one to the end within two blocks of theirs,
+// joined by the table: min d(s, a) + D(a, b) + d(b, t). Closer ones search the maze. The cells
+// between consecutive transit nodes of the table paths are searched once, queries copy them.
+// Blocks are preprocessed in parallel; an edit refreshes the tables of the blocks it touches and
+// the access nodes of the blocks around them, then fills the global table again (a search per
+// transit node over the block tables, its time is printed).
+class TransitNodes
+{
+public:
+	static constexpr uint32_t MAX_NODES = 2048;
+
+	// Queries between blocks this far apart (in blocks, either way) go through the tables
+	static constexpr uint32_t FAR = 4;
+
+	// A block size of 0 picks the smallest one that keeps the transit nodes under MAX_NODES,
+	// up to an eighth of the maze
+	TransitNodes(Maze* maze, uint32_t size = 0);
+
+	// Refresh the tables if the maze changed, returns false if there are too many transit nodes
+	bool Update();
+
+	// Cells from s (on top) to t, empty if there is no path. Cost is UINT32_MAX without path
+	std::stack<Pair> Query(const Pair& s, const Pair& t, uint32_t& cost);
+
+	// Table entries read by the last query
+	uint32_t getLookups() const { return lookups; }
+
+	uint32_t GetNodeCount() const { return (uint32_t)cells.size(); }
+
+	uint32_t GetBlockSize() const { return size; }
+private:
+	struct block
+	{
+		std::vector<uint32_t> nodes; // Border cells
+		std::vector<uint32_t> table; // nodes x nodes distances inside the block
+		std::vector<uint32_t> access; // Access node cells
+	};
+
+	// Search state of a thread, over the cells of the maze
+	struct workspace
+	{
+		std::vector<uint32_t> dist;
+		std::vector<uint32_t> parent;
+		std::vector<uint32_t> stamp;
+		uint32_t current;
+		std::vector<std::pair<uint32_t, uint32_t>> openList;
+		std::vector<uint32_t> seen; // Stamps of the cells traced back by Access
+	};
+
+	uint32_t BlockOf(uint32_t cell) const { return (cell / cols / size) * blockCols + (cell % cols) / size; }
+
+	// Whether the cell is at most 'radius' blocks away from block b, either way
+	bool IsAround(uint32_t cell, uint32_t b, uint32_t radius) const;
+
+	bool IsNode(uint32_t cell) const;
+
+	// Fill the border cells and the table of a block
+	void Prepare(uint32_t b, workspace& ws);
+
+	// Fill the access nodes of a block, from its border cells
+	void Access(uint32_t b, workspace& ws);
+
+	// Dijkstra within 'radius' blocks of the block of the cell (UINT32_MAX: the whole maze), done once
+	// 'target' is settled. Backward searches give the distances to the cell
+	void Local(uint32_t cell, bool backward, uint32_t radius, uint32_t target, workspace& ws) const;
+
+	// Number the border cells and the transit nodes, and fill the global table
+	bool Connect();
+private:
+	Maze* maze;
+	uint32_t fixed; // Block size asked for, 0 if automatic
+	uint32_t revision;
+	bool built;
+	bool usable;
+	uint32_t size;
+	int rows, cols;
+	uint32_t blockRows, blockCols;
+	uint32_t lookups;
+	std::vector<block> blocks;
+	std::vector<uint32_t> cells; // Transit node -> cell
+	std::vector<uint32_t> index; // Cell -> transit node (UINT32_MAX if not one)
+	std::vector<uint32_t> dist; // Global table, transit nodes x transit nodes
+	std::vector<uint16_t> via; // Transit node before the last on the path of the global table
+	// Steps from a transit node to the next one on these paths: the transit node reached and the cells after the first
+	std::vector<uint32_t> stepStart;
+	std::vector<uint32_t> stepTo;
+	std::vector<uint32_t> stepBegin;
+	std::vector<uint32_t> stepCells;
+	std::vector<workspace> workspaces; // One per thread of the preprocessing
+	workspace search[2]; // Forward from the start and backward from the end of a query
+};
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "TreeIndex.hpp"
+#include <algorithm>
+
+TreeIndex::TreeIndex(Maze* maze) : maze(maze), revision(0), built(false), isTree(false)
+{
+}
+
+bool TreeIndex::Update()
+{
+	if (!built || revision != maze->GetRevision()) {
+		this->Build();
+	}
+
+	return isTree;
+}
+
+void TreeIndex::Build()
+{
+	int ROW = maze->GetRows();
+	int COL = maze->GetCols();
+	uint32_t V = ROW * COL;
+
+	constexpr Pair coords[] = {
+		             Pair(-1, 0),
+		Pair(0, -1)             , Pair(0, 1),
+		             Pair(1, 0) ,
+	};
+
+	revision = maze->GetRevision();
+	built = true;
+	isTree = true;
+	parent.assign(V, UINT32_MAX);
+	root.assign(V, UINT32_MAX);
+	cost.assign(V, 0);
+	level.assign(V, 0);
+	first.assign(V, UINT32_MAX);
+	tour.clear();
+	table.clear();
+
+	// Iterative DFS from every cell not reached yet, a stack of <cell, next direction>
+	std::vector<std::pair<uint32_t, uint32_t>> stack;
+
+	for (uint32_t r = 0; r < V && isTree; r++) {
+		if (root[r] != UINT32_MAX || !maze->isUnBlocked(r / COL, r % COL))
+			continue;
+
+		root[r] = r;
+		first[r] = (uint32_t)tour.size();
+		tour.push_back(r);
+		stack.push_back(std::make_pair(r, 0u));
+
+		while (!stack.empty() && isTree) {
+			uint32_t u = stack.back().first;
+			uint32_t k = stack.back().second;
+
+			if (k == 4) {
+				stack.pop_back();
+
+				if (!stack.empty())
+					tour.push_back(stack.back().first);
+
+				continue;
+			}
+
+			stack.back().second++;
+
+			int ni = u / COL + coords[k].first;
+			int nj = u % COL + coords[k].second;
+
+			if (!maze->isValid(ni, nj) || !maze->isUnBlocked(ni, nj))
+				continue;
+
+			uint32_t v = ni * COL + nj;
+
+			if (v == parent[u])
+				continue;
+
+			if (root[v] != UINT32_MAX) { // Reached twice: there is a cycle
+				isTree = false;
+				break;
+			}
+
+			root[v] = r;
+			parent[v] = u;
+			cost[v] = cost[u] + maze->getCellCost(ni, nj);
+			level[v] = level[u] + 1;
+			first[v] = (uint32_t)tour.size();
+			tour.push_back(v);
+			stack.push_back(std::make_pair(v, 0u));
+		}
+	}
+
+	if (!isTree) {
+		tour.clear();
+		return;
+	}
+
+	// Sparse table over the Euler tour
+	uint32_t n = (uint32_t)tour.size();
+	table.push_back(tour);
+
+	for (uint32_t k = 1; (1u << k) <= n; k++) {
+		const std::vector<uint32_t>& prev = table[k - 1];
+		std::vector<uint32_t> row(n - (1u << k) + 1);
+
+		for (uint32_t i = 0; i < row.size(); i++) {
+			uint32_t a = prev[i];
+			uint32_t b = prev[i + (1u << (k - 1))];
+			row[i] = level[a] <= level[b] ? a : b;
+		}
+
+		table.push_back(row);
+	}
+}
+
+bool TreeIndex::Connected(uint32_t u, uint32_t v) const
+{
+	return root[u] != UINT32_MAX && root[u] == root[v];
+}
+
+uint32_t TreeIndex::LCA(uint32_t u, uint32_t v) const
+{
+	uint32_t l = std::min(first[u], first[v]);
+	uint32_t r = std::max(first[u], first[v]) + 1;
+	uint32_t k = 0;
+
+	while ((2u << k) <= r - l)
+		k++;
+
+	uint32_t a = table[k][l];
+	uint32_t b = table[k][r - (1u << k)];
+	return level[a] <= level[b] ? a : b;
+}
+
+uint32_t TreeIndex::Distance(const Pair& s, const Pair& t) const
+{
+	if (!isTree || !maze->isValid(s) || !maze->isValid(t))
+		return UINT32_MAX;
+
+	uint32_t u = this->Id(s);
+	uint32_t v = this->Id(t);
+
+	if (!this->Connected(u, v))
+		return UINT32_MAX;
+
+	uint32_t l = this->LCA(u, v);
+	return cost[u] + cost[v] - 2 * cost[l] + maze->getCellCost(l / maze->GetCols(), l % maze->GetCols()) - maze->getCellCost(s.first, s.second);
+}
+
+std::stack<Pair> TreeIndex::Path(const Pair& s, const Pair& t) const
+{
+	std::stack<Pair> path;
+
+	if (!isTree || !maze->isValid(s) || !maze->isValid(t))
+		return path;
+
+	uint32_t u = this->Id(s);
+	uint32_t v = this->Id(t);
+
+	if (!this->Connected(u, v))
+		return path;
+
+	int COL = maze->GetCols();
+	uint32_t l = this->LCA(u, v);
+	std::vector<uint32_t> up; // s up to the common ancestor, excluded
+
+	for (uint32_t c = u; c != l; c = parent[c])
+		up.push_back(c);
+
+	// t up to the common ancestor goes at the bottom of the stack, then s down to it
+	for (uint32_t c = v; c != l; c = parent[c])
+		path.push(Pair(c / COL, c % COL));
+
+	path.push(Pair(l / COL, l % COL));
+
+	for (std::vector<uint32_t>::reverse_iterator it = up.rbegin(); it != up.rend(); ++it)
+		path.push(Pair(*it / COL, *it % COL));
+
+	return path;
+}
\ No newline at end of file
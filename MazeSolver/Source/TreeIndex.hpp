@@ -0,0 +1,49 @@
+#pragma once
+
+#include "maze.hpp"
+#include <stack>
+#include <vector>
+
+class Maze;
+
+// Path queries on a perfect maze (no cycle between the open cells), same moves as Dijkstra.
+// Every tree is rooted and walked once: Euler tour with a sparse table for the lowest common
+// ancestor, and the cost from the root to every cell (cost of the entered cells).
+// Distances are then O(1) and paths O(path length). The index is rebuilt when the maze
+// changes and stays unused as soon as an edit makes a cycle.
+class TreeIndex
+{
+public:
+	TreeIndex(Maze* maze);
+
+	// Rebuild if the maze changed, returns true if the queries can be used
+	bool Update();
+
+	bool IsTree() const { return isTree; }
+
+	// Cost from s to t, UINT32_MAX if they are not connected
+	uint32_t Distance(const Pair& s, const Pair& t) const;
+
+	// Cells from s (on top) to t, empty if they are not connected
+	std::stack<Pair> Path(const Pair& s, const Pair& t) const;
+private:
+	void Build();
+
+	uint32_t LCA(uint32_t u, uint32_t v) const;
+
+	uint32_t Id(const Pair& cell) const { return cell.first * maze->GetCols() + cell.second; }
+
+	bool Connected(uint32_t u, uint32_t v) const;
+private:
+	Maze* maze;
+	uint32_t revision;
+	bool built;
+	bool isTree;
+	std::vector<uint32_t> parent; // UINT32_MAX for roots and walls
+	std::vector<uint32_t> root;
+	std::vector<uint32_t> cost; // From the root, the root excluded
+	std::vector<uint32_t> level;
+	std::vector<uint32_t> first; // First position in the Euler tour
+	std::vector<uint32_t> tour;
+	std::vector<std::vector<uint32_t>> table; // table[k][i]: shallowest cell of tour[i, i + 2^k)
+};
\ No newline at end of file
@@ -0,0 +1,546 @@
+#include "WHCAStar.hpp"
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+
+constexpr uint32_t ReservationTable::FREE;
+
+ReservationTable::ReservationTable(uint32_t window, uint32_t agents) : window(0), mask(0), now(0)
+{
+	this->Resize(window, agents);
+}
+
+// Drop every reservation and size the slices for the given number of agents (load factor <= 1/2)
+void ReservationTable::Resize(uint32_t window, uint32_t agents)
+{
+	uint32_t capacity = 8;
+	entry e = { FREE, FREE };
+
+	while (capacity < 2 * agents)
+		capacity <<= 1;
+
+	this->window = window;
+	mask = capacity - 1;
+	slices.assign(window + 1, std::vector<entry>(capacity, e));
+}
+
+void ReservationTable::Advance()
+{
+	entry e = { FREE, FREE };
+	std::vector<entry>& s = Slice(now);
+
+	// The slice of the time that just expired becomes the one of now + window
+	std::fill(s.begin(), s.end(), e);
+	now++;
+}
+
+uint32_t ReservationTable::Owner(uint32_t t, uint32_t cell) const
+{
+	if (t < now || t > now + window)
+		return FREE;
+
+	const std::vector<entry>& s = Slice(t);
+
+	for (uint32_t i = Hash(cell) & mask; s[i].cell != FREE; i = (i + 1) & mask) {
+		if (s[i].cell == cell)
+			return s[i].agent;
+	}
+
+	return FREE;
+}
+
+bool ReservationTable::Reserve(uint32_t t, uint32_t cell, uint32_t agent)
+{
+	if (t < now || t > now + window)
+		return false;
+
+	std::vector<entry>& s = Slice(t);
+	uint32_t i = Hash(cell) & mask;
+
+	for (; s[i].cell != FREE; i = (i + 1) & mask) {
+		if (s[i].cell == cell)
+			return s[i].agent == agent;
+	}
+
+	s[i].cell = cell;
+	s[i].agent = agent;
+	return true;
+}
+
+void ReservationTable::Release(uint32_t t, uint32_t cell, uint32_t agent)
+{
+	if (t < now || t > now + window)
+		return;
+
+	std::vector<entry>& s = Slice(t);
+	uint32_t i = Hash(cell) & mask;
+
+	while (s[i].cell != cell) {
+		if (s[i].cell == FREE)
+			return;
+
+		i = (i + 1) & mask;
+	}
+
+	if (s[i].agent != agent)
+		return;
+
+	// Backward shift deletion: move back the entries of the cluster that would become unreachable
+	for (uint32_t j = (i + 1) & mask; s[j].cell != FREE; j = (j + 1) & mask) {
+		uint32_t k = Hash(s[j].cell) & mask;
+		bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+
+		if (!stays) {
+			s[i] = s[j];
+			i = j;
+		}
+	}
+
+	s[i].cell = FREE;
+	s[i].agent = FREE;
+}
+
+WHCAStar::WHCAStar(Maze* maze, uint32_t window) :
+	maze(maze), window(window > 0 ? window : 1), priority(0), expansions(0), table(window > 0 ? window : 1, 1)
+{
+}
+
+uint32_t WHCAStar::AddAgent(const Pair& start, const Pair& goal)
+{
+	agent a;
+	a.pos = start;
+	a.goal = goal;
+	a.planTime = table.getTime();
+	a.replan = true;
+	a.reachable = true;
+	agents.push_back(a);
+
+	// The slices are sized for the number of agents: rebuild the table and let everyone replan
+	table.Resize(window, (uint32_t)agents.size());
+
+	for (agent& other : agents) {
+		other.plan.clear();
+		other.replan = true;
+	}
+
+	return (uint32_t)agents.size() - 1;
+}
+
+void WHCAStar::SetGoal(uint32_t id, const Pair& goal)
+{
+	if (agents[id].goal != goal) {
+		this->MoveHeuristic(agents[id].goal, goal, agents[id].pos.first * maze->GetCols() + agents[id].pos.second);
+		agents[id].goal = goal;
+		agents[id].replan = true;
+	}
+}
+
+WHCAStar::heuristic& WHCAStar::GetHeuristic(uint32_t goal, uint32_t origin)
+{
+	std::map<uint32_t, heuristic>::iterator it = heuristics.find(goal);
+
+	if (it == heuristics.end()) {
+		heuristic& h = heuristics[goal];
+		this->Start(h.current, goal, origin);
+		h.pending = false;
+		h.used = true;
+		return h;
+	}
+
+	it->second.used = true;
+	return it->second;
+}
+
+void WHCAStar::Start(search& s, uint32_t anchor, uint32_t origin)
+{
+	uint32_t COL = maze->GetCols();
+
+	s.anchor = anchor;
+	s.origin = origin;
+	s.drift = 0;
+	s.moves = 0;
+	s.openList.clear();
+	s.g.clear();
+	s.closed.clear();
+	s.g[anchor] = 0;
+	s.openList.push_back(std::make_pair((uint32_t)(std::abs((int)(anchor / COL) - (int)(origin / COL))
+		+ std::abs((int)(anchor % COL) - (int)(origin % COL))) * Maze::getMinCost(), anchor));
+}
+
+void WHCAStar::MoveHeuristic(const Pair& from, const Pair& to, uint32_t origin)
+{
+	uint32_t COL = maze->GetCols();
+	std::map<uint32_t, heuristic>::iterator it = heuristics.find(from.first * COL + from.second);
+
+	// Already handed over by an agent with the same goal
+	if (it == heuristics.end() || heuristics.count(to.first * COL + to.second))
+		return;
+
+	// Cheapest way back from the new cell into the old one on 4 directions, through a corner after a diagonal move
+	int dr = from.first - to.first;
+	int dc = from.second - to.second;
+	uint32_t back = UINT32_MAX;
+
+	if (std::abs(dr) + std::abs(dc) == 1) {
+		back = maze->getCellCost(from.first, from.second);
+	} else if (std::abs(dr) == 1 && std::abs(dc) == 1) {
+		const Pair corners[] = { Pair(to.first + dr, to.second), Pair(to.first, to.second + dc) };
+
+		for (const Pair& corner : corners) {
+			if (maze->isUnBlocked(corner))
+				back = std::min(back, maze->getCellCost(corner.first, corner.second) + maze->getCellCost(from.first, from.second));
+		}
+	}
+
+	if (back == UINT32_MAX) // Jumped away, a new search starts
+		return;
+
+	heuristic h = std::move(it->second);
+	heuristics.erase(it);
+
+	h.current.drift += back;
+	h.current.moves++;
+
+	if (h.pending) {
+		h.next.drift += back;
+		h.next.moves++;
+	} else if (h.current.moves >= window) {
+		this->Start(h.next, to.first * COL + to.second, origin);
+		h.pending = true;
+	}
+
+	heuristics.insert(std::make_pair(to.first * COL + to.second, std::move(h)));
+}
+
+void WHCAStar::GrowHeuristics()
+{
+	uint32_t COL = maze->GetCols();
+
+	for (std::map<uint32_t, heuristic>::iterator it = heuristics.begin(); it != heuristics.end(); ++it) {
+		heuristic& h = it->second;
+
+		if (!h.pending)
+			continue;
+
+		// As much as a plan may expand
+		uint32_t budget = 64 * (window + 1);
+		bool ready = true;
+
+		for (const agent& a : agents) {
+			uint32_t cell = a.pos.first * COL + a.pos.second;
+
+			if (a.goal.first * COL + a.goal.second != it->first)
+				continue;
+
+			this->Distance(h.next, cell, &budget);
+			ready = ready && (h.next.closed.count(cell) || h.next.openList.empty());
+		}
+
+		if (ready) {
+			std::swap(h.current, h.next);
+			h.pending = false;
+		}
+	}
+}
+
+// True distance from the cell to the anchor (ignoring the other agents), UINT32_MAX if unreachable
+uint32_t WHCAStar::Distance(search& s, uint32_t cell, uint32_t* budget)
+{
+	if (s.closed.count(cell))
+		return s.g[cell];
+
+	int COL = maze->GetCols();
+	int oi = s.origin / COL;
+	int oj = s.origin % COL;
+
+	constexpr Pair coords[] = {
+		             Pair(-1, 0),
+		Pair(0, -1)             , Pair(0, 1),
+		             Pair(1, 0) ,
+	};
+
+	while (!s.openList.empty() && !(budget && *budget == 0)) {
+		std::pop_heap(s.openList.begin(), s.openList.end(), std::greater<std::pair<uint32_t, uint32_t>>());
+		uint32_t v = s.openList.back().second;
+		s.openList.pop_back();
+
+		if (!s.closed.insert(v).second) // Already expanded
+			continue;
+
+		if (budget)
+			(*budget)--;
+
+		int i = v / COL;
+		int j = v % COL;
+		// Searching backward: stepping from a neighbour into v costs the cost of v
+		uint32_t g = s.g[v] + maze->getCellCost(i, j);
+
+		for (const Pair& dir : coords) {
+			int ni = i + dir.first;
+			int nj = j + dir.second;
+
+			if (!maze->isValid(ni, nj) || !maze->isUnBlocked(ni, nj))
+				continue;
+
+			uint32_t u = ni * COL + nj;
+
+			if (s.closed.count(u))
+				continue;
+
+			std::unordered_map<uint32_t, uint32_t>::iterator it = s.g.find(u);
+
+			if (it == s.g.end() || g < it->second) {
+				s.g[u] = g;
+				s.openList.push_back(std::make_pair(g + (uint32_t)(std::abs(ni - oi) + std::abs(nj - oj)) * Maze::getMinCost(), u));
+				std::push_heap(s.openList.begin(), s.openList.end(), std::greater<std::pair<uint32_t, uint32_t>>());
+			}
+		}
+
+		if (v == cell)
+			return s.g[v];
+	}
+
+	return UINT32_MAX;
+}
+
+uint32_t WHCAStar::Estimate(heuristic& h, uint32_t cell, uint32_t goal)
+{
+	uint32_t d = this->Distance(h.current, cell);
+
+	if (d == UINT32_MAX)
+		return UINT32_MAX;
+
+	// d(cell, goal) >= d(cell, anchor) - d(goal, anchor), and never below the Manhattan distance
+	int COL = maze->GetCols();
+	uint32_t manhattan = (uint32_t)(std::abs((int)(cell / COL) - (int)(goal / COL)) + std::abs((int)(cell % COL) - (int)(goal % COL))) * Maze::getMinCost();
+
+	return d >= h.current.drift + manhattan ? d - h.current.drift : manhattan;
+}
+
+void WHCAStar::ReleasePlan(uint32_t id)
+{
+	agent& a = agents[id];
+
+	for (uint32_t k = 0; k < a.plan.size(); k++) {
+		if (a.planTime + k >= table.getTime())
+			table.Release(a.planTime + k, a.plan[k], id);
+	}
+
+	a.plan.clear();
+}
+
+void WHCAStar::Plan(uint32_t id)
+{
+	uint32_t COL = maze->GetCols();
+	uint32_t now = table.getTime();
+
+	constexpr Pair coords[] = {
+		Pair(0, 0)  , Pair(-1, 0),
+		Pair(0, -1) , Pair(0, 1),
+		Pair(1, 0)  ,
+	};
+
+	this->ReleasePlan(id);
+
+	agent& a = agents[id];
+	uint32_t src = a.pos.first * COL + a.pos.second;
+	uint32_t goal = a.goal.first * COL + a.goal.second;
+	heuristic& h = GetHeuristic(goal, src);
+	uint32_t hs = this->Estimate(h, src, goal);
+
+	a.planTime = now;
+	a.replan = false;
+	a.reachable = (hs != UINT32_MAX);
+
+	// Space-time A* over (cell, t) for t in [0, window], a node is identified by cell * (window + 1) + t
+	nodes.clear();
+	openList.clear();
+	visited.clear();
+
+	node root = { src, 0, 0, UINT32_MAX, false };
+	nodes.push_back(root);
+	visited[(uint64_t)src * (window + 1)] = 0;
+	openList.push_back(openEntry(a.reachable ? hs : 0, std::make_pair(0, 0)));
+
+	uint32_t best = UINT32_MAX;
+	uint32_t count = 0;
+	uint32_t limit = 64 * (window + 1); // Hard bound on the work of a plan
+
+	while (a.reachable && !openList.empty()) {
+		std::pop_heap(openList.begin(), openList.end(), std::greater<openEntry>());
+		openEntry p = openList.back();
+		openList.pop_back();
+
+		uint32_t idx = p.second.second;
+
+		if (nodes[idx].closed || nodes[idx].g != p.second.first)
+			continue;
+
+		node n = nodes[idx];
+
+		// The end of the window (or the goal) is reached, or the work limit is hit: take the best node
+		if (n.t == window || n.cell == goal || count == limit) {
+			best = idx;
+			break;
+		}
+
+		nodes[idx].closed = true;
+		expansions++;
+		count++;
+
+		int i = n.cell / COL;
+		int j = n.cell % COL;
+		uint32_t t = now + n.t + 1;
+
+		for (const Pair& dir : coords) {
+			int ni = i + dir.first;
+			int nj = j + dir.second;
+
+			if (!maze->isValid(ni, nj) || !maze->isUnBlocked(ni, nj))
+				continue;
+
+			uint32_t cell = ni * COL + nj;
+			uint32_t owner = table.Owner(t, cell);
+
+			if (owner != ReservationTable::FREE && owner != id) // Somebody is there at t
+				continue;
+
+			if (cell != n.cell) { // Two agents can't swap their cells
+				owner = table.Owner(t - 1, cell);
+
+				if (owner != ReservationTable::FREE && owner != id && table.Owner(t, n.cell) == owner)
+					continue;
+			}
+
+			uint32_t hd = this->Estimate(h, cell, goal);
+
+			if (hd == UINT32_MAX)
+				continue;
+
+			// Moving costs the cell we enter, waiting costs 1 (nothing on the goal)
+			uint32_t newG = n.g + (cell != n.cell ? maze->getCellCost(ni, nj) : (n.cell == goal ? 0 : 1));
+			uint64_t key = (uint64_t)cell * (window + 1) + n.t + 1;
+			std::unordered_map<uint64_t, uint32_t>::iterator it = visited.find(key);
+
+			if (it == visited.end()) {
+				node m = { cell, n.t + 1, newG, idx, false };
+				visited[key] = (uint32_t)nodes.size();
+				openList.push_back(openEntry(newG + hd, std::make_pair(newG, (uint32_t)nodes.size())));
+				nodes.push_back(m);
+			} else if (!nodes[it->second].closed && newG < nodes[it->second].g) {
+				nodes[it->second].g = newG;
+				nodes[it->second].parent = idx;
+				openList.push_back(openEntry(newG + hd, std::make_pair(newG, it->second)));
+			} else {
+				continue;
+			}
+
+			std::push_heap(openList.begin(), openList.end(), std::greater<openEntry>());
+		}
+	}
+
+	// Rebuild the plan (hold the position if nothing was found)
+	if (best == UINT32_MAX)
+		best = 0;
+
+	for (uint32_t idx = best; idx != UINT32_MAX; idx = nodes[idx].parent)
+		a.plan.push_back(nodes[idx].cell);
+
+	std::reverse(a.plan.begin(), a.plan.end());
+
+	// Stay on the last cell for the rest of the window
+	while (a.plan.size() <= window && table.Owner(now + (uint32_t)a.plan.size(), a.plan.back()) == ReservationTable::FREE)
+		a.plan.push_back(a.plan.back());
+
+	for (uint32_t k = 0; k < a.plan.size(); k++) {
+		if (!table.Reserve(now + k, a.plan[k], id)) {
+			a.plan.resize(k);
+			break;
+		}
+	}
+
+	if (a.plan.empty()) // Somebody reserved our own cell, stand still anyway
+		a.plan.push_back(src);
+}
+
+void WHCAStar::Tick()
+{
+	uint32_t n = (uint32_t)agents.size();
+	uint32_t now = table.getTime();
+	std::vector<uint32_t> holds;
+
+	expansions = 0;
+
+	// Every agent must own a cell at now + 1: those without a plan covering it hold their position,
+	// and a hold wins over any plan that wanted that cell (the planner is sent back to replan)
+	for (uint32_t id = 0; id < n; id++) {
+		if (now - agents[id].planTime + 1 >= agents[id].plan.size())
+			holds.push_back(id);
+	}
+
+	while (!holds.empty()) {
+		uint32_t id = holds.back();
+		agent& a = agents[id];
+		uint32_t cell = a.pos.first * maze->GetCols() + a.pos.second;
+		uint32_t owner = table.Owner(now + 1, cell);
+
+		holds.pop_back();
+
+		if (owner != ReservationTable::FREE && owner != id) {
+			this->ReleasePlan(owner);
+			agents[owner].replan = true;
+			holds.push_back(owner);
+		}
+
+		this->ReleasePlan(id);
+		a.plan.push_back(cell);
+		a.plan.push_back(cell);
+		a.planTime = now;
+		a.replan = true;
+		table.Reserve(now, cell, id);
+		table.Reserve(now + 1, cell, id);
+	}
+
+	this->GrowHeuristics();
+
+	// Replan in a rotating priority order: an agent replans when its goal changed or half of its window is consumed
+	for (uint32_t k = 0; k < n; k++) {
+		uint32_t id = (priority + k) % n;
+		agent& a = agents[id];
+		uint32_t elapsed = now - a.planTime;
+
+		if (a.replan || elapsed + 1 >= a.plan.size() || elapsed >= window / 2)
+			this->Plan(id);
+	}
+
+	if (n > 0)
+		priority = (priority + 1) % n;
+
+	// Forget the heuristics of goals nobody is heading to anymore
+	for (std::map<uint32_t, heuristic>::iterator it = heuristics.begin(); it != heuristics.end(); ++it)
+		it->second.used = false;
+
+	for (agent& a : agents) {
+		std::map<uint32_t, heuristic>::iterator it = heuristics.find(a.goal.first * maze->GetCols() + a.goal.second);
+
+		if (it != heuristics.end())
+			it->second.used = true;
+	}
+
+	for (std::map<uint32_t, heuristic>::iterator it = heuristics.begin(); it != heuristics.end();) {
+		if (!it->second.used)
+			it = heuristics.erase(it);
+		else
+			++it;
+	}
+
+	// Every agent follows its plan by one step
+	for (agent& a : agents) {
+		uint32_t elapsed = now - a.planTime;
+
+		if (elapsed + 1 < a.plan.size())
+			a.pos = maze->Get2DCoord(a.plan[elapsed + 1]);
+	}
+
+	table.Advance();
+}
\ No newline at end of file
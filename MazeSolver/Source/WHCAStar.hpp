@@ -0,0 +1,160 @@
+#pragma once
+
+#include "maze.hpp"
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <map>
+
+class Maze;
+
+// Space-time reservation table covering the times [now, now + window].
+// Each time step is a small open addressing table (cell -> agent), so the
+// memory and the cost of a tick depend on the window and the number of agents only.
+class ReservationTable
+{
+public:
+	static constexpr uint32_t FREE = UINT32_MAX;
+
+	ReservationTable(uint32_t window = 16, uint32_t agents = 1);
+
+	void Resize(uint32_t window, uint32_t agents);
+
+	// Slide the window by one step
+	void Advance();
+
+	// Agent holding the cell at time t, FREE if nobody does (or t is outside the window)
+	uint32_t Owner(uint32_t t, uint32_t cell) const;
+
+	bool Reserve(uint32_t t, uint32_t cell, uint32_t agent);
+
+	void Release(uint32_t t, uint32_t cell, uint32_t agent);
+
+	uint32_t getTime() const { return now; }
+
+	uint32_t getWindow() const { return window; }
+private:
+	struct entry
+	{
+		uint32_t cell;
+		uint32_t agent;
+	};
+
+	std::vector<entry>& Slice(uint32_t t) { return slices[t % slices.size()]; }
+
+	const std::vector<entry>& Slice(uint32_t t) const { return slices[t % slices.size()]; }
+
+	static uint32_t Hash(uint32_t cell) { uint32_t h = cell * 2654435761u; return h ^ (h >> 16); }
+private:
+	std::vector<std::vector<entry>> slices;
+	uint32_t window;
+	uint32_t mask;
+	uint32_t now;
+};
+
+// Windowed Hierarchical Cooperative A*: every agent plans a space-time path of
+// 'window' steps around the cells reserved by the others, guided by the true
+// distance to its goal computed by a Reverse Resumable A* (shared by agents with the same goal).
+// When the goal steps to a neighbour cell the reverse search goes on, its distances less the
+// way back to where it started still bound the distances to the goal. Every 'window' moves of the
+// goal a new search starts from there, grown by a bounded number of expansions per tick until it
+// reaches the agents, so a tick costs as much as the plans whatever the size of the maze.
+// Agents move on the 4 orthogonal directions and may wait in place.
+class WHCAStar
+{
+public:
+	WHCAStar(Maze* maze, uint32_t window = 16);
+
+	uint32_t AddAgent(const Pair& start, const Pair& goal);
+
+	void SetGoal(uint32_t agent, const Pair& goal);
+
+	// Replan the agents that need it (rotating priorities) and move every agent by one step
+	void Tick();
+
+	const Pair& GetPosition(uint32_t agent) const { return agents[agent].pos; }
+
+	// False when the agent's goal can't be reached from where it stands
+	bool HasPath(uint32_t agent) const { return agents[agent].reachable; }
+
+	size_t GetAgentCount() const { return agents.size(); }
+
+	uint32_t getExpansions() const { return expansions; }
+private:
+	struct agent
+	{
+		Pair pos;
+		Pair goal;
+		std::vector<uint32_t> plan; // plan[k] is the cell held at time planTime + k
+		uint32_t planTime;
+		bool replan;
+		bool reachable;
+	};
+
+	// Reverse Resumable A*: backward search from the anchor (the goal when it started), resumed until the asked cell is closed
+	struct search
+	{
+		uint32_t anchor;
+		uint32_t origin;
+		uint32_t drift; // Cost of a path from the goal back to the anchor
+		uint32_t moves; // Of the goal since the anchor
+		std::vector<std::pair<uint32_t, uint32_t>> openList; // <f, cell> heap
+		std::unordered_map<uint32_t, uint32_t> g;
+		std::unordered_set<uint32_t> closed;
+	};
+
+	// Distances toward a goal: the search in use, and the one started from where the goal went until it takes over
+	struct heuristic
+	{
+		search current;
+		search next;
+		bool pending;
+		bool used;
+	};
+
+	// Node of the windowed space-time search
+	struct node
+	{
+		uint32_t cell;
+		uint32_t t;
+		uint32_t g;
+		uint32_t parent;
+		bool closed;
+	};
+
+	// Open list entry of the windowed search: <f, <g, node>>
+	typedef std::pair<uint32_t, std::pair<uint32_t, uint32_t>> openEntry;
+
+	void Start(search& s, uint32_t anchor, uint32_t origin);
+
+	// Stops after *budget expansions when given (the cell isn't closed then)
+	uint32_t Distance(search& s, uint32_t cell, uint32_t* budget = NULL);
+
+	// Lower bound of the cost from the cell to the goal followed by the heuristic, UINT32_MAX if unreachable
+	uint32_t Estimate(heuristic& h, uint32_t cell, uint32_t goal);
+
+	// Hand the heuristic of a goal over to the neighbour cell it moved to, origin is where the agent stands
+	void MoveHeuristic(const Pair& from, const Pair& to, uint32_t origin);
+
+	// Grow the pending searches, a new one replaces the one in use once it closed the cells of its agents
+	void GrowHeuristics();
+
+	heuristic& GetHeuristic(uint32_t goal, uint32_t origin);
+
+	void Plan(uint32_t id);
+
+	void ReleasePlan(uint32_t id);
+private:
+	Maze* maze;
+	uint32_t window;
+	uint32_t priority;
+	uint32_t expansions;
+	ReservationTable table;
+	std::vector<agent> agents;
+	std::map<uint32_t, heuristic> heuristics;
+
+	// Scratch space of the windowed search, reused between the plans
+	std::vector<node> nodes;
+	std::vector<openEntry> openList;
+	std::unordered_map<uint64_t, uint32_t> visited; // (cell, t) -> node
+};
\ No newline at end of file
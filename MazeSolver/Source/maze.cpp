@@ -5,66 +5,72 @@
 #include <chrono>
 #include <set>
 #include "AStar.hpp"
-
-Maze::Maze() : texture_sz{ 0, 0, 768, 768 }, start(1, 1), end(1, 1)
-{
-}
-
-Maze::wall_t Maze::getRandomCell()
-{
-	int pick = random_n(101);
-
-	if (pick <= 50) {
-		return wall_t::SPACE;
-	} else if (pick > 50 && pick <= 80) {
-		return wall_t::STONE;
-	} else if (pick > 80 && pick <= 95) {
-		return wall_t::SAND;
-	} else if (pick > 95 && pick <= 100) {
-		return wall_t::WATER;
-	}
-
-	return wall_t::SPACE;
-}
-
-uint32_t Maze::getCellCost(int row, int col) const
+#include "LRTAStar.hpp"
+#include "WHCAStar.hpp"
+#include "FlowField.hpp"
+#include "PursuitSolver.hpp"
+#include "PathDatabase.hpp"
+#include "TiledGenerator.hpp"
+#include "KruskalGenerator.hpp"
+#include "ThreadPool.hpp"
+
+CostTable Maze::costs;
+
+const Pair Maze::MOVES[8] = {
+	Pair(-1, -1), Pair(-1, 0), Pair(-1, 1),
+	Pair(0, -1)              , Pair(0, 1),
+	Pair(1, -1), Pair(1, 0)  , Pair(1, 1),
+};
+
+Maze::Maze() : texture_sz{ 0, 0, 768, 768 }, start(1, 1), end(1, 1), H(0), W(0), revision(0), edits_base(0), moves_revision(0), moves_built(false),
+	cat_type(CAT_ASTAR), cat_budget(64), cat_count(1), cat_window(16),
+	mouse_type(MOUSE_RANDOM), generator_type(GENERATOR_BACKTRACK), grid_type(GRID_BYTES), layout_type(LAYOUT_ROWS), cell_bits(8), thread_count(0), seed(std::random_device()()), rng(seed)
 {
-	switch (maze[row][col]) {
-	case wall_t::SPACE:
-		return 1;
-	case wall_t::STONE:
-		return 2;
-	case wall_t::SAND:
-		return 3;
-	case wall_t::WATER:
-		return 4;
-	}
-
-	return UINT32_MAX;
 }
 
 void Maze::Clear()
 {
-	maze = MazeArray(H, std::vector<uint32_t>(W, wall_t::WALL));
+	maze = MazeArray(H, W, wall_t::WALL, cell_bits, maze.IsTiled());
+	revision++;
+	edits.clear();
+	edits_base = revision;
 }
 
 
 void Maze::Reset()
 {
-	maze = MazeArray(H, std::vector<uint32_t>(W, wall_t::SPACE));
+	maze = MazeArray(H, W, wall_t::SPACE, cell_bits, maze.IsTiled());
 
-	maze[0] = std::vector<uint32_t>(W, wall_t::WALL);
-	maze[H - 2] = std::vector<uint32_t>(W, wall_t::WALL);
+	for (int j = 0; j < W; j++) {
+		maze.Set(0, j, wall_t::WALL);
+		maze.Set(H - 2, j, wall_t::WALL);
+	}
 
 	for (int i = 0; i < H; i++) {
-		maze[i][0] = wall_t::WALL;
-		maze[i][W - 2] = wall_t::WALL;
+		maze.Set(i, 0, wall_t::WALL);
+		maze.Set(i, W - 2, wall_t::WALL);
 	}
+
+	revision++;
+	edits.clear();
+	edits_base = revision;
 }
 
 void Maze::Generate()
 {
-	this->BuildMaze();
+	if (generator_type == GENERATOR_TILED) {
+		TiledGenerator tiled(this);
+		tiled.Build(rng.Next(), thread_count);
+	} else if (generator_type == GENERATOR_KRUSKAL) {
+		KruskalGenerator kruskal(this);
+		kruskal.Build(rng.Next(), thread_count);
+	} else {
+		this->BuildMaze();
+	}
+
+	revision++;
+	edits.clear();
+	edits_base = revision;
 }
 
 void Maze::Init(SDL_Renderer* renderer, int h, int w)
@@ -74,61 +80,68 @@ void Maze::Init(SDL_Renderer* renderer, int h, int w)
 
 	start = std::pair<uint32_t, uint32_t>(1, 1);
 	end = std::pair<uint32_t, uint32_t>(W - 3, H - 3);
+	cell_bits = 8;
+
+	if (grid_type == GRID_PACKED && costs.GetMaxType() < 16) {
+		cell_bits = 4;
+	} else if (grid_type == GRID_PACKED) {
+		printf("The terrain has types above 15, the cells keep a byte each\n");
+	}
 
-	maze = MazeArray(H, std::vector<uint32_t>(W, wall_t::WALL));
+	maze = MazeArray(H, W, wall_t::WALL, cell_bits, layout_type == LAYOUT_TILES);
 	this->renderer = renderer;
-	texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, W - 1, H - 1);
+	texture = NULL;
+
+	if (renderer) { // No renderer when running headless
+		texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, W - 1, H - 1);
+	}
+
 	this->Generate();
 }
 
-void Maze::DigMaze(int r, int c, uint32_t* wall)
+void Maze::DigMaze(int r, int c, int top, int left, int bottom, int right, Random& rng)
 {
-	if (r < 0 || c < 0 || r >= maze.size() || c >= maze[0].size()) // bounds check
-		return;
+	int COL = W;
 
-	if (maze[r][c] == wall_t::WALL || maze[r][c] == wall_t::SPACE) // Did we get visited already ?
+	if (r < top || c < left || r >= bottom || c >= right || maze.Get(r, c) != wall_t::TRACE) // bounds check, and not visited yet
 		return;
 
-	if (wall) { // Wall is null on first call
-		*wall = getRandomCell(); // A wall we jumped over, set it to random cell (empty,stone, sand or water)
-	}
+	// Depth first with an explicit stack of cells (row * COL + col) instead of recursion: the top cell
+	// digs toward a random neighbour not visited yet, and is dropped once it has none left
+	constexpr int DIR_ROW[] = { -2, 2, 0, 0 }; // N, S, E, W
+	constexpr int DIR_COL[] = { 0, 0, 2, -2 };
+	std::vector<uint32_t> stack;
 
-	maze[r][c] = getRandomCell(); // Dig this cell.
+	maze.Set(r, c, getRandomCell(rng)); // Dig this cell.
+	stack.push_back(r * COL + c);
 
-	// Randomly decide the order in which we explore the directions
-	// N, S, E, W.  We use STL's random_shuffle() to shuffle an array.
-	uint32_t D[4] = { 'N', 'S', 'E', 'W' };
-	std::random_shuffle(D, D + 4, random_n);
+	while (!stack.empty()) {
+		r = stack.back() / COL;
+		c = stack.back() % COL;
 
-	for (int i = 0; i < 4; i++) {
-		// m[rr][cc] will be the cell that we'll try to dig.
-		int rr = r;
-		int cc = c;
-		uint32_t* wall;
+		uint32_t D[4];
+		uint32_t count = 0;
 
-		switch (D[i]) {
-		case 'N':
-			rr -= 2;
-			wall = &maze[r - 1][c];
-			break;
-		case 'S':
-			rr += 2;
-			wall = &maze[r + 1][c];
-			break;
-		case 'W':
-			cc -= 2;
-			wall = &maze[r][c - 1];
-			break;
-		case 'E':
-			cc += 2;
-			wall = &maze[r][c + 1];
-			break;
-		default:
-			exit(1);
+		for (uint32_t d = 0; d < 4; d++) {
+			int rr = r + DIR_ROW[d];
+			int cc = c + DIR_COL[d];
+
+			if (rr >= top && cc >= left && rr < bottom && cc < right && maze.Get(rr, cc) == wall_t::TRACE)
+				D[count++] = d;
+		}
+
+		if (count == 0) {
+			stack.pop_back();
+			continue;
 		}
 
-		// recursively dig from (rr,cc).
-		this->DigMaze(rr, cc, wall);
+		uint32_t d = D[rng(count)];
+		int rr = r + DIR_ROW[d];
+		int cc = c + DIR_COL[d];
+
+		maze.Set(r + DIR_ROW[d] / 2, c + DIR_COL[d] / 2, getRandomCell(rng)); // A wall we jumped over, set it to random cell (empty,stone, sand or water)
+		maze.Set(rr, cc, getRandomCell(rng));
+		stack.push_back(rr * COL + cc);
 	}
 }
 
@@ -137,18 +150,18 @@ void Maze::BuildMaze()
 	// min/maxRow/Col indicate the "interior" of the maze.
 	int minRow = 1;
 	int minCol = 1;
-	size_t maxRow = maze.size() - 2;
-	size_t maxCol = maze[0].size() - 2;
+	size_t maxRow = H - 2;
+	size_t maxCol = W - 2;
 
 	// Initialize the maze matrix m in alternating walls and cells
 	for (int r = minRow; r <= maxRow; r += 2) {
 		for (int c = minCol; c <= maxCol; c += 2) {
-			maze[r][c] = wall_t::TRACE;
+			maze.Set(r, c, wall_t::TRACE);
 		}
 	}
 
-	// Start digging recursively.
-	this->DigMaze(1, 1, NULL);
+	// Start digging.
+	this->DigMaze(1, 1, 0, 0, H, W, rng);
 }
 
 void Maze::DisplayMaze()
@@ -160,9 +173,9 @@ void Maze::DisplayMaze()
 	SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0x00);
 	SDL_RenderClear(renderer);
 
-	for (int row = 0; row < maze.size(); row++) {
-		for (int col = 0; col < maze[0].size(); col++) {
-			this->ColorCase(&r, row, col, maze[row][col]);
+	for (int row = 0; row < H; row++) {
+		for (int col = 0; col < W; col++) {
+			this->ColorCase(&r, row, col, getColor(maze.Get(row, col)));
 		}
 	}
 
@@ -172,10 +185,37 @@ void Maze::DisplayMaze()
 	SDL_RenderCopy(renderer, texture, NULL, &texture_sz);
 }
 
+// Draw the cats on top of the maze (the first one is the start point)
+void Maze::DisplayCats(const std::vector<Pair>& cats)
+{
+	SDL_Rect r;
+	r.w = TILE_W;
+	r.h = TILE_H;
+	SDL_SetRenderTarget(renderer, texture);
+
+	for (const Pair& cat : cats) {
+		this->ColorCase(&r, cat.first, cat.second, 0xFF, 0x0, 0x0);
+	}
+
+	SDL_SetRenderTarget(renderer, NULL);
+	SDL_RenderCopy(renderer, texture, NULL, &texture_sz);
+}
+
 void Maze::SetCell(wall_t type, int row, int col)
 {
-	if (row < maze.size() - 2 && col < maze[0].size() - 2 && (row != 0 && col != 0))
-		maze[row][col] = type;
+	if (row > 0 && col > 0 && row < H - 2 && col < W - 2 && maze.Get(row, col) != type) {
+		edit_t e = { Pair(row, col), maze.Get(row, col), (uint32_t)type };
+
+		// Keep a bounded history, whoever is too late rebuilds from the maze
+		if (edits.size() >= 4096) {
+			edits.clear();
+			edits_base = revision;
+		}
+
+		edits.push_back(e);
+		maze.Set(row, col, type);
+		revision++;
+	}
 }
 
 void Maze::ColorCase(SDL_Rect* rect, int row, int col, int r, int g, int b)
@@ -199,8 +239,8 @@ void Maze::ColorCase(SDL_Rect* rect, int row, int col, uint32_t color)
 std::pair<uint32_t, uint32_t> Maze::Get2DCoord(uint32_t coord)
 {
 	std::pair<uint32_t, uint32_t> p;
-	p.first = coord / (uint32_t)maze[0].size();
-	p.second = coord % (uint32_t)maze[0].size();
+	p.first = coord / (uint32_t)W;
+	p.second = coord % (uint32_t)W;
 	return p;
 }
 
@@ -210,16 +250,16 @@ Graph Maze::ConstructGraph()
 	Graph graph(H * W);
 	constexpr int coords[] = { -1, 1 };
 	
-	for (uint32_t row = 0; row < (uint32_t)maze.size(); row++) {
-		for (uint32_t col = 0; col < (uint32_t)maze[0].size(); col++) {
-			uint32_t vert_id = row * (uint32_t)maze[0].size() + col;
+	for (uint32_t row = 0; row < (uint32_t)H; row++) {
+		for (uint32_t col = 0; col < (uint32_t)W; col++) {
+			uint32_t vert_id = row * (uint32_t)W + col;
 
 			for (int offset : coords) {
 				uint32_t ncol = col;
 				uint32_t nrow = row + offset;
 			
-				if (nrow >= 0 && nrow < (uint32_t)maze.size() && maze[nrow][ncol] != wall_t::WALL) {
-					uint32_t nvert_id = nrow * (uint32_t)maze[0].size() + ncol;
+				if (nrow >= 0 && nrow < (uint32_t)H && isUnBlocked(nrow, ncol)) {
+					uint32_t nvert_id = nrow * (uint32_t)W + ncol;
 					graph.AddEdgeToVertex(vert_id, nvert_id, getCellCost(nrow, col));
 				}
 			}
@@ -228,9 +268,9 @@ Graph Maze::ConstructGraph()
 				uint32_t ncol = col + offset;
 				uint32_t nrow = row;
 
-				if (ncol >= 0 && ncol < (uint32_t)maze[0].size() && maze[nrow][ncol] != wall_t::WALL) {
-					uint32_t nvert_id = nrow * (uint32_t)maze[0].size() + ncol;
-					graph.AddEdgeToVertex(vert_id, nvert_id, getCellCost(nrow, col));
+				if (ncol >= 0 && ncol < (uint32_t)W && isUnBlocked(nrow, ncol)) {
+					uint32_t nvert_id = nrow * (uint32_t)W + ncol;
+					graph.AddEdgeToVertex(vert_id, nvert_id, getCellCost(nrow, ncol));
 				}
 			}
 		}
@@ -239,20 +279,59 @@ Graph Maze::ConstructGraph()
 	return graph;
 }
 
-// Is cell valid
-bool Maze::isValid(int row, int col)
+void Maze::UpdateMoves()
 {
+	if (moves_built && moves_revision == revision)
+		return;
 
-	return (row >= 0) && (row < this->H) && (col >= 0) && (col < this->W);
+	bool incremental = moves_built && moves_revision >= edits_base && revision - edits_base == edits.size();
+
+	// An edit changes one bit in the masks of the cells around it (never outside of the maze, the border can't be edited)
+	for (uint32_t k = incremental ? moves_revision - edits_base : 0; incremental && k < edits.size(); k++) {
+		const Pair& cell = edits[k].cell;
+		uint8_t open = isUnBlocked(cell) ? 1 : 0;
+
+		for (int d = 0; d < 8; d++) {
+			uint8_t& mask = moves[maze.Index(cell.first + MOVES[d].first, cell.second + MOVES[d].second)];
+			mask = (uint8_t)((mask & ~(1 << (7 - d))) | (open << (7 - d))); // Seen from there, the cell is in the opposite direction
+		}
+	}
+
+	if (!incremental) {
+		moves.assign(maze.GetCapacity(), 0);
+		uint32_t words = (W + 63) / 64;
+		ThreadPool pool(thread_count);
+
+		// The rows above and below are there for every row of the maze, the sentinels around it are walls
+		pool.ParallelFor(H, [&](uint32_t begin, uint32_t end, uint32_t) {
+			std::vector<uint64_t> rows(3 * words);
+			auto open = [&](int k, int col) { return col >= 0 && col < W ? (uint32_t)(rows[k * words + col / 64] >> (col % 64)) & 1 : 0u; };
+
+			for (uint32_t row = begin; row < end; row++) {
+				for (int k = 0; k < 3; k++)
+					this->GetRowMask(row + k - 1, &rows[k * words]);
+
+				for (int col = 0; col < W; col++) {
+					uint8_t mask = 0;
+
+					for (int d = 0; d < 8; d++)
+						mask |= open(MOVES[d].first + 1, col + MOVES[d].second) << d;
+
+					moves[maze.Index(row, col)] = mask;
+				}
+			}
+		}, 64);
+	}
+
+	moves_revision = revision;
+	moves_built = true;
 }
 
-// Is cell blocked
-bool Maze::isUnBlocked(int row, int col)
+// Is cell valid
+bool Maze::isValid(int row, int col)
 {
-	if (this->maze[row][col] != Maze::wall_t::WALL)
-		return true;
-	else
-		return false;
+
+	return (row >= 0) && (row < this->H) && (col >= 0) && (col < this->W);
 }
 
 // Simulate Cat and Mouse
@@ -263,11 +342,77 @@ void Maze::CatAndMouse()
 	Pair end = this->getEnd();
 
 	bool blocked = false;
-	Pair cat = this->getStart();
 	Pair mouse = this->getEnd();
 	std::set<Pair> mouse_steps;
 	mouse_steps.insert(mouse);
 
+	// The first cat leaves from the start point, the others from random free cells
+	std::vector<Pair> cats(1, this->getStart());
+
+	for (uint32_t tries = 0; cats.size() < cat_count && tries < 1000 * cat_count; tries++) {
+		Pair cell(rng(H), rng(W));
+
+		if (isUnBlocked(cell) && cell != mouse && std::find(cats.begin(), cats.end(), cell) == cats.end()) {
+			cats.push_back(cell);
+		}
+	}
+
+	// Real-time controllers, keep what they learned between the steps
+	std::vector<LRTAStar> lrta;
+
+	// Cooperative planner, the cats plan around each other
+	WHCAStar whca(this, cat_window);
+
+	// Flow field toward the mouse, read by every cat
+	FlowField flow(this);
+
+	if (cat_type == CAT_FLOW) {
+		flow.Build(mouse);
+	}
+
+	// Capture tables, both agents may play perfectly
+	PursuitSolver solver(this);
+	cat_t cat_mode = cat_type;
+	mouse_t mouse_mode = mouse_type;
+	uint32_t escaped = 0;
+
+	if (cat_mode == CAT_OPTIMAL || mouse_mode == MOUSE_OPTIMAL) {
+		if (solver.Build(thread_count)) {
+			uint32_t plies = solver.MovesToCapture(cats[0], mouse, false);
+
+			if (plies == UINT32_MAX)
+				printf("The mouse can escape the cat forever\n");
+			else
+				printf("The cat catches the mouse in %u moves\n", (plies + 1) / 2);
+		} else {
+			cat_mode = (cat_mode == CAT_OPTIMAL) ? CAT_ASTAR : cat_mode;
+			mouse_mode = MOUSE_RANDOM;
+		}
+	}
+
+	// First moves toward every cell, the cats don't search at all
+	PathDatabase database(this);
+
+	if (cat_mode == CAT_CPD) {
+		auto begin = std::chrono::steady_clock::now();
+
+		if (database.Build(thread_count)) {
+			printf("Path database of %u cells built in %.1f ms: %u runs (%.1f per cell)\n", database.getCellCount(),
+				std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count(),
+				database.getRunCount(), (double)database.getRunCount() / std::max(1u, database.getCellCount()));
+		} else {
+			cat_mode = CAT_ASTAR;
+		}
+	}
+
+	for (const Pair& cat : cats) {
+		if (cat_mode == CAT_LRTA) {
+			lrta.push_back(LRTAStar(this, cat_budget));
+		} else if (cat_mode == CAT_WHCA) {
+			whca.AddAgent(cat, mouse);
+		}
+	}
+
 	SDL_Event event;
 
 	Pair coords[] = {
@@ -280,41 +425,136 @@ void Maze::CatAndMouse()
 		SDL_PollEvent(&event);
 		// Check where the mouse can run:
 		blocked = true;
-		std::random_shuffle(coords, coords + 4, random_n); //  Randomise psotion
+		std::random_shuffle(coords, coords + 4, rng); //  Randomise psotion
 
-		for (const Pair& off : coords) {
-			Pair future_step = mouse + off;
-			const bool is_in = mouse_steps.find(future_step) != mouse_steps.end();
+		if (mouse_mode == MOUSE_OPTIMAL) {
+			// Run from the cat closest to a capture
+			Pair threat = cats[0];
 
-			if (isValid(future_step) && isUnBlocked(future_step) && !is_in) {
-				mouse = future_step;
-				mouse_steps.insert(mouse);
-				blocked = false;
-				setEnd(mouse);
+			for (const Pair& cat : cats) {
+				if (solver.MovesToCapture(cat, mouse, false) < solver.MovesToCapture(threat, mouse, false))
+					threat = cat;
+			}
 
-				this->DisplayMaze();
-				SDL_RenderPresent(renderer);
+			if (!solver.CatWins(threat, mouse, false) && ++escaped > solver.getCellCount()) {
+				printf("The mouse escaped\n");
 				break;
 			}
+
+			Pair future_step = solver.BestMouseMove(threat, mouse);
+
+			for (LRTAStar& agent : lrta) {
+				agent.TargetMoved(mouse, future_step);
+			}
+
+			mouse = future_step;
+			blocked = false;
+			setEnd(mouse);
+
+			this->DisplayMaze();
+			this->DisplayCats(cats);
+			SDL_RenderPresent(renderer);
+		} else {
+			for (const Pair& off : coords) {
+				Pair future_step = mouse + off;
+				const bool is_in = mouse_steps.find(future_step) != mouse_steps.end();
+
+				if (isValid(future_step) && isUnBlocked(future_step) && !is_in) {
+					for (LRTAStar& agent : lrta) {
+						agent.TargetMoved(mouse, future_step);
+					}
+
+					mouse = future_step;
+					mouse_steps.insert(mouse);
+					blocked = false;
+					setEnd(mouse);
+
+					this->DisplayMaze();
+					this->DisplayCats(cats);
+					SDL_RenderPresent(renderer);
+					break;
+				}
+			}
 		}
 
-		AStar astar(this);
-		std::stack<Pair> path = astar.AStarSearch(AStar::MANHATTAN, cat, mouse);
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		bool moved = false; // Did at least one cat find a path ?
 
-		if (!path.empty()) {
-			path.pop(); // Pop our current position 
-			cat = path.top();
-			setStart(cat);
+		if (cat_mode == CAT_FLOW) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			flow.MoveTarget(mouse);
 
-			if (cat == mouse) {
-				break;
+			for (Pair& cat : cats) {
+				if (flow.GetDistance(cat) != UINT32_MAX) {
+					cat = flow.GetNext(cat);
+					moved = true;
+				}
+			}
+		} else if (cat_mode == CAT_WHCA) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+			for (uint32_t i = 0; i < cats.size(); i++) {
+				whca.SetGoal(i, mouse);
+			}
+
+			whca.Tick();
+
+			for (uint32_t i = 0; i < cats.size(); i++) {
+				cats[i] = whca.GetPosition(i);
+				moved = moved || whca.HasPath(i);
+			}
+		} else if (cat_mode == CAT_CPD) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+			for (Pair& cat : cats) {
+				Pair next = database.GetNext(cat, mouse);
+				moved = moved || next != cat;
+				cat = next;
+			}
+		} else if (cat_mode == CAT_OPTIMAL) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+			for (Pair& cat : cats) {
+				cat = solver.BestCatMove(cat, mouse);
+				moved = true;
+			}
+		} else if (cat_mode == CAT_LRTA) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+			for (uint32_t i = 0; i < cats.size(); i++) {
+				Pair next;
+
+				if (lrta[i].Step(cats[i], mouse, next)) {
+					cats[i] = next;
+					moved = true;
+				}
 			}
 		} else {
+			for (Pair& cat : cats) {
+				AStar astar(this);
+				std::stack<Pair> path = astar.AStarSearch(AStar::MANHATTAN, cat, mouse);
+
+				if (!path.empty()) {
+					path.pop(); // Pop our current position 
+					cat = path.top();
+					moved = true;
+				}
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		}
+
+		if (!moved) {
 			break; // No Path
 		}
 
+		setStart(cats[0]);
+
+		if (std::find(cats.begin(), cats.end(), mouse) != cats.end()) {
+			break;
+		}
+
 		this->DisplayMaze();
+		this->DisplayCats(cats);
 		SDL_RenderPresent(renderer);
 	}
 
@@ -6,18 +6,13 @@
 #include <algorithm>
 #include <random>
 #include "graph.hpp"
+#include "Random.hpp"
+#include "CellGrid.hpp"
+#include "CostTable.hpp"
 #include <SDL.h>
 #include <stdint.h>
 #include <limits.h>
 
-static uint32_t random_n(uint32_t n)
-{ 
-	std::random_device dev;
-	std::mt19937 rng(dev());
-	std::uniform_int_distribution<std::mt19937::result_type> dist(0, n - 1);
-	return dist(rng);
-}
-
 // Creating a shortcut for int, int pair type 
 typedef std::pair<int, int> Pair;
 
@@ -36,17 +31,66 @@ struct SDL_Rect;
 class Maze
 {
 public:
-	typedef std::vector<std::vector<uint32_t>> MazeArray;
+	typedef CellGrid MazeArray;
 
+	// Built-in cell types, one byte per cell. The terrain (see GetCostTable) tells how they are crossed and drawn, and may add others
 	enum wall_t {
-		WALL = 0x000000,
-		SPACE = 0xffffff,
+		WALL = 0,
+		SPACE = 1,
+
+		STONE = 2,
+		SAND = 3,
+		WATER = 4,
+
+		TRACE = 5,
+	};
+
+	// Controllers available for the cat in the Cat & Mouse simulation
+	enum cat_t {
+		CAT_ASTAR = 0,
+		CAT_LRTA = 1,
+		CAT_WHCA = 2,
+		CAT_FLOW = 3,
+		CAT_OPTIMAL = 4,
+		CAT_CPD = 5,
+	};
+
+	// Moves allowed to the searches: Dijkstra uses 4 directions, A* 8
+	enum moves_t {
+		MOVES_4 = 0,
+		MOVES_8 = 1,
+	};
+
+	// A cell changed by SetCell
+	struct edit_t
+	{
+		Pair cell;
+		uint32_t before, after;
+	};
+
+	// Controllers available for the mouse
+	enum mouse_t {
+		MOUSE_RANDOM = 0,
+		MOUSE_OPTIMAL = 1,
+	};
+
+	// Algorithms generating the maze
+	enum generator_t {
+		GENERATOR_BACKTRACK = 0, // One depth first search
+		GENERATOR_TILED = 1, // Depth first searches on tiles in parallel, stitched together
+		GENERATOR_KRUSKAL = 2, // Randomized Kruskal, in parallel
+	};
 
-		STONE = 0xabaeaf,
-		SAND = 0xDBD1B4,
-		WATER = 0xadd8e6,
+	// How the cells are stored
+	enum grid_t {
+		GRID_BYTES = 0, // One byte per cell
+		GRID_PACKED = 1, // 4 bits per cell, when the terrain has no type above 15
+	};
 
-		TRACE = 0xffff00,
+	// Order of the cells in memory, and of the state of the searches following it
+	enum layout_t {
+		LAYOUT_ROWS = 0, // Row after row
+		LAYOUT_TILES = 1, // Tiles of 8x8 cells, the neighbours of a cell mostly in its cache line
 	};
 public:
     Maze();
@@ -55,7 +99,8 @@ public:
 
 	void Init(SDL_Renderer* renderer, int h = 32, int w = 32);
 
-    void DigMaze(int r, int c, uint32_t* wall);
+	// Depth first from (r, c) over the cells marked TRACE, inside the rows [top, bottom) and the columns [left, right)
+	void DigMaze(int r, int c, int top, int left, int bottom, int right, Random& rng);
 
     void BuildMaze();
 
@@ -70,6 +115,33 @@ public:
 	// Cat & Mouse functions:
 	void CatAndMouse();
 
+	void setCatController(cat_t type) { cat_type = type; }
+
+	void setCatBudget(uint32_t budget) { cat_budget = budget; }
+
+	void setCatCount(uint32_t count) { cat_count = count > 0 ? count : 1; }
+
+	void setCatWindow(uint32_t window) { cat_window = window; }
+
+	void setMouseController(mouse_t type) { mouse_type = type; }
+
+	void setGenerator(generator_t type) { generator_type = type; }
+
+	void setGrid(grid_t type) { grid_type = type; }
+
+	void setLayout(layout_t type) { layout_type = type; }
+
+	void setThreadCount(uint32_t threads) { thread_count = threads; }
+
+	uint32_t GetThreadCount() const { return thread_count; }
+
+	// The mazes generated from now on (and the cat & mouse runs) are the same for the same seed
+	void setSeed(uint64_t seed) { this->seed = seed; rng.Seed(seed); }
+
+	uint64_t getSeed() const { return seed; }
+
+	void DisplayCats(const std::vector<Pair>& cats);
+
 	// Dijsktra functions:
 	Graph ConstructGraph();
 
@@ -78,13 +150,46 @@ public:
 
 	int GetW() const { return W - 2; }
 
+	// Full grid dimensions, border included
+	int GetRows() const { return H; }
+
+	int GetCols() const { return W; }
+
+	// Incremented every time a cell of the maze changes
+	uint32_t GetRevision() const { return revision; }
+
 	void SetCell(wall_t type, int row, int col);
 
+	// Cells changed since the revision GetEditsBase(), older edits are forgotten
+	const std::vector<edit_t>& GetEdits() const { return edits; }
+
+	uint32_t GetEditsBase() const { return edits_base; }
+
 	SDL_Rect& getRect() { return texture_sz; }
 
-	uint32_t getCellCost(int row, int col) const;
+	uint32_t getCellCost(int row, int col) const { return costs.GetCost(maze.Get(row, col)); }
+
+	// Terrain shared by all the mazes, to be loaded before they are made
+	static CostTable& GetCostTable() { return costs; }
+
+	// Cost of entering a cell of that type (UINT32_MAX for a wall)
+	static uint32_t getCost(uint32_t type) { return costs.GetCost((uint8_t)type); }
 
-	wall_t getRandomCell();
+	// Cheapest cell, what a heuristic counting moves multiplies them by to stay admissible
+	static uint32_t getMinCost() { return costs.GetMinCost(); }
+
+	static uint32_t getMaxCost() { return costs.GetMaxCost(); }
+
+	// Color of a cell type on screen
+	static uint32_t getColor(uint32_t type) { return costs.GetColor((uint8_t)type); }
+
+	uint8_t getRandomCell() { return getRandomCell(rng); }
+
+	// Following the shares of the terrain: empty cell half of the time, else stone, sand or water
+	static uint8_t getRandomCell(Random& rng) { return getRandomCell(rng(101)); }
+
+	// Cell drawn for a number in [0, 100]
+	static uint8_t getRandomCell(uint32_t pick) { return costs.GetType(pick); }
 
 	void setStart(const std::pair<uint32_t, uint32_t>& s) { start = s; };
 
@@ -104,18 +209,55 @@ public:
 
 	bool isValid(int row, int col);
 
-	bool isUnBlocked(int row, int col);
+	bool isUnBlocked(int row, int col) const { return costs.IsPassable(maze.Get(row, col)); }
+
+	// Place of the state of a cell in the arrays of a search, in the order of the grid
+	size_t GetIndex(int row, int col) const { return maze.Index(row, col); }
+
+	size_t GetIndexCount() const { return maze.GetCapacity(); }
+
+	// Bits of the open cells of a row, 64 per word, (GetCols() + 63) / 64 words
+	void GetRowMask(int row, uint64_t* mask) const { maze.MatchRow(row, costs.GetPassable(), mask); }
+
+	// Open neighbours of a cell, bit d for the move MOVES[d] (none outside of the maze), as of the last UpdateMoves
+	uint8_t getMoves(int row, int col) const { return moves[maze.Index(row, col)]; }
+
+	// Masks of the open neighbours of every cell, built from the rows of the grid and then refreshed around the edits
+	void UpdateMoves();
+
+	// The 8 moves of A*, row by row from the top left
+	static const Pair MOVES[8];
 
 	bool isValid(const Pair& cell) { return isValid(cell.first, cell.second); }
 
-	bool isUnBlocked(const Pair& cell) { return isUnBlocked(cell.first, cell.second); }
+	bool isUnBlocked(const Pair& cell) const { return isUnBlocked(cell.first, cell.second); }
 private:
+	static CostTable costs;
+
     MazeArray maze;
 	SDL_Texture* texture;
 	SDL_Renderer* renderer;
 	SDL_Rect texture_sz;
 	std::pair<uint32_t, uint32_t> start, end;
     int H, W;
+	uint32_t revision;
+	std::vector<edit_t> edits;
+	uint32_t edits_base;
+	std::vector<uint8_t> moves; // In the order of GetIndex
+	uint32_t moves_revision;
+	bool moves_built;
+	cat_t cat_type;
+	uint32_t cat_budget;
+	uint32_t cat_count;
+	uint32_t cat_window;
+	mouse_t mouse_type;
+	generator_t generator_type;
+	grid_t grid_type;
+	layout_t layout_type;
+	uint32_t cell_bits; // Of the grid made by Init, kept (as its layout) by Clear and Reset
+	uint32_t thread_count;
+	uint64_t seed;
+	Random rng;
 
 	static constexpr int TILE_W = 1;
 	static constexpr int TILE_H = 1;
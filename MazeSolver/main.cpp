@@ -3,24 +3,248 @@
 #include <utility>
 #include <algorithm>
 #include <iostream>
+#include <cstring>
 
 
 #include "Source/maze.hpp"
 #include "Source/MazeSolver.hpp"
+#include "Source/Benchmark.hpp"
 
 using namespace std;
 
 int main(int argc, char* argv[])
 {
 	uint32_t maze_sz = 64;
+	Maze::cat_t cat_type = Maze::CAT_ASTAR;
+	uint32_t cat_budget = 64;
+	uint32_t cat_count = 1;
+	uint32_t cat_window = 16;
+	Maze::mouse_t mouse_type = Maze::MOUSE_RANDOM;
+	Maze::generator_t generator = Maze::GENERATOR_BACKTRACK;
+	Maze::grid_t grid = Maze::GRID_BYTES;
+	Maze::layout_t layout = Maze::LAYOUT_ROWS;
+	uint32_t threads = 0;
+	uint32_t sim_cats = 0, sim_mice = 0, sim_ticks = 0;
+	uint32_t queries = 0;
+	uint32_t searches = 0;
+	uint32_t layout_searches = 0;
+	int32_t blocks = -1;
+	const char* ch_file = NULL;
+	const char* costs_file = NULL;
+	bool transit = false;
+	bool seeded = false;
+	uint64_t seed = 0;
+	uint32_t stream_width = 0;
+	uint64_t stream_height = 0;
+	const char* stream_file = NULL;
 
 	if (argc >= 2) {
 		maze_sz = atoi(argv[1]);
 		maze_sz = (maze_sz % 2 ? maze_sz + 1 : maze_sz);
 	}
 
+	// Options: --cat astar|lrta|whca|flow|optimal|cpd, --mouse random|optimal, --budget expansions per step of the real-time cat,
+	// --generator backtrack|tiled|kruskal selects how the maze is generated, --grid bytes|packed how its cells are stored, --layout rows|tiles in which order,
+	// --cats number of cats, --window steps planned ahead by the cooperative cats,
+	// --simulate cats mice ticks runs the multi-agent simulation without window, --threads (0: one per core),
+	// --costs file loads the terrain (cost, color and share of every cell type) from the file,
+	// --seed n generates the same mazes (and cat & mouse runs) every time, --stream width height file writes a maze row by row (0 rows: no end, '-': standard output),
+	// --ch file loads (or builds and saves) the contraction hierarchy of Dijkstra, --transit answers Dijkstra from the transit node tables,
+	// --queries n times both without window, --subgoals n times the subgoal graph against A* without window,
+	// --layouts n times A* on the same maze in both layouts without window, --open blocks empties the maze of these benchmarks but for random blocks
+	for (int i = 2; i < argc; i++) {
+		if (strcmp(argv[i], "--cat") == 0 && i + 1 < argc) {
+			i++;
+
+			if (strcmp(argv[i], "lrta") == 0) {
+				cat_type = Maze::CAT_LRTA;
+			} else if (strcmp(argv[i], "whca") == 0) {
+				cat_type = Maze::CAT_WHCA;
+			} else if (strcmp(argv[i], "flow") == 0) {
+				cat_type = Maze::CAT_FLOW;
+			} else if (strcmp(argv[i], "optimal") == 0) {
+				cat_type = Maze::CAT_OPTIMAL;
+			} else if (strcmp(argv[i], "cpd") == 0) {
+				cat_type = Maze::CAT_CPD;
+			} else if (strcmp(argv[i], "astar") == 0) {
+				cat_type = Maze::CAT_ASTAR;
+			} else {
+				printf("Unknown cat controller '%s'\n", argv[i]);
+			}
+		} else if (strcmp(argv[i], "--mouse") == 0 && i + 1 < argc) {
+			i++;
+
+			if (strcmp(argv[i], "optimal") == 0) {
+				mouse_type = Maze::MOUSE_OPTIMAL;
+			} else if (strcmp(argv[i], "random") == 0) {
+				mouse_type = Maze::MOUSE_RANDOM;
+			} else {
+				printf("Unknown mouse controller '%s'\n", argv[i]);
+			}
+		} else if (strcmp(argv[i], "--generator") == 0 && i + 1 < argc) {
+			i++;
+
+			if (strcmp(argv[i], "backtrack") == 0) {
+				generator = Maze::GENERATOR_BACKTRACK;
+			} else if (strcmp(argv[i], "tiled") == 0) {
+				generator = Maze::GENERATOR_TILED;
+			} else if (strcmp(argv[i], "kruskal") == 0) {
+				generator = Maze::GENERATOR_KRUSKAL;
+			} else {
+				printf("Unknown generator '%s'\n", argv[i]);
+			}
+		} else if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc) {
+			i++;
+
+			if (strcmp(argv[i], "bytes") == 0) {
+				grid = Maze::GRID_BYTES;
+			} else if (strcmp(argv[i], "packed") == 0) {
+				grid = Maze::GRID_PACKED;
+			} else {
+				printf("Unknown grid '%s'\n", argv[i]);
+			}
+		} else if (strcmp(argv[i], "--layout") == 0 && i + 1 < argc) {
+			i++;
+
+			if (strcmp(argv[i], "rows") == 0) {
+				layout = Maze::LAYOUT_ROWS;
+			} else if (strcmp(argv[i], "tiles") == 0) {
+				layout = Maze::LAYOUT_TILES;
+			} else {
+				printf("Unknown layout '%s'\n", argv[i]);
+			}
+		} else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+			cat_budget = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--cats") == 0 && i + 1 < argc) {
+			cat_count = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+			cat_window = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			threads = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--simulate") == 0 && i + 3 < argc) {
+			sim_cats = atoi(argv[++i]);
+			sim_mice = atoi(argv[++i]);
+			sim_ticks = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--ch") == 0 && i + 1 < argc) {
+			ch_file = argv[++i];
+		} else if (strcmp(argv[i], "--costs") == 0 && i + 1 < argc) {
+			costs_file = argv[++i];
+		} else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+			seed = strtoull(argv[++i], NULL, 10);
+			seeded = true;
+		} else if (strcmp(argv[i], "--stream") == 0 && i + 3 < argc) {
+			stream_width = atoi(argv[++i]);
+			stream_height = strtoull(argv[++i], NULL, 10);
+			stream_file = argv[++i];
+		} else if (strcmp(argv[i], "--transit") == 0) {
+			transit = true;
+		} else if (strcmp(argv[i], "--queries") == 0 && i + 1 < argc) {
+			queries = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--subgoals") == 0 && i + 1 < argc) {
+			searches = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--layouts") == 0 && i + 1 < argc) {
+			layout_searches = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--open") == 0 && i + 1 < argc) {
+			blocks = atoi(argv[++i]);
+		} else {
+			printf("Unknown option '%s'\n", argv[i]);
+		}
+	}
+
+	// Before any maze is made, the default terrain stays if the file can't be read
+	if (costs_file)
+		Maze::GetCostTable().Load(costs_file);
+
+	if (stream_file) { // Eller's generator, the maze is never held in memory
+		Benchmark::Stream(stream_width, stream_height, stream_file, seeded ? seed : std::random_device()());
+		return 0;
+	}
+
+	if (sim_ticks > 0) { // Headless benchmark
+		Maze maze;
+
+		if (seeded)
+			maze.setSeed(seed);
+
+		maze.setGenerator(generator);
+		maze.setGrid(grid);
+		maze.setLayout(layout);
+		maze.setThreadCount(threads);
+
+		maze.Init(NULL, maze_sz, maze_sz);
+		Benchmark::Simulate(&maze, sim_cats, sim_mice, sim_ticks, threads);
+		return 0;
+	}
+
+	if (layout_searches > 0) { // The same maze in both layouts
+		Maze mazes[2];
+		uint64_t maze_seed = seeded ? seed : std::random_device()();
+		unsigned int blocks_seed = std::random_device()();
+
+		for (int k = 0; k < 2; k++) {
+			mazes[k].setSeed(maze_seed);
+			mazes[k].setGenerator(generator);
+			mazes[k].setGrid(grid);
+			mazes[k].setLayout(k == 0 ? Maze::LAYOUT_ROWS : Maze::LAYOUT_TILES);
+			mazes[k].setThreadCount(threads);
+			mazes[k].Init(NULL, maze_sz, maze_sz);
+
+			if (blocks >= 0) {
+				srand(blocks_seed);
+				Benchmark::OpenMaze(&mazes[k], blocks);
+			}
+		}
+
+		Benchmark::Layouts(&mazes[0], &mazes[1], layout_searches);
+		return 0;
+	}
+
+	if (queries > 0 || searches > 0) {
+		Maze maze;
+
+		if (seeded)
+			maze.setSeed(seed);
+
+		maze.setGenerator(generator);
+		maze.setGrid(grid);
+		maze.setLayout(layout);
+		maze.setThreadCount(threads);
+
+		maze.Init(NULL, maze_sz, maze_sz);
+
+		if (blocks >= 0)
+			Benchmark::OpenMaze(&maze, blocks);
+
+		if (queries > 0)
+			Benchmark::Queries(&maze, queries, threads, ch_file);
+
+		if (searches > 0)
+			Benchmark::Subgoals(&maze, searches, threads);
+
+		return 0;
+	}
+
 	MazeSolver mazeSolv(1280, 768, maze_sz, maze_sz);
 
+	mazeSolv.getMaze().setCatController(cat_type);
+	mazeSolv.getMaze().setCatBudget(cat_budget);
+	mazeSolv.getMaze().setCatCount(cat_count);
+	mazeSolv.getMaze().setCatWindow(cat_window);
+	mazeSolv.getMaze().setMouseController(mouse_type);
+	mazeSolv.getMaze().setThreadCount(threads);
+
+	if (seeded)
+		mazeSolv.getMaze().setSeed(seed);
+
+	mazeSolv.getMaze().setGenerator(generator);
+	mazeSolv.getMaze().setGrid(grid);
+	mazeSolv.getMaze().setLayout(layout);
+
+	if (ch_file)
+		mazeSolv.setIndexFile(ch_file);
+
+	mazeSolv.setTransitNodes(transit);
+
 	mazeSolv.Init();
 
 	mazeSolv.Loop();